@@ -3,18 +3,79 @@
 // -----------------------------------------------------------------------------
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdint.h>
-#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
 #include "esp32/rom/ets_sys.h"
 #include "driver/gpio.h"
 #include "dht.h"
+#include "dht_decode.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros
+// -----------------------------------------------------------------------------
+
+#define DHT_MAX_EDGES           (2 * DHT_FRAME_PULSES + 4)
+#define DHT_FRAME_TIMEOUT_MS    10      /**< response + 40 bits take ~5 ms */
+#define DHT_IDLE_TIMEOUT_US     100     /**< pull-up must raise the line */
+
+#ifdef DHT_FIXED_TYPE
+#define DHT_PROFILE(sensor)     (&dht_profiles[DHT_FIXED_TYPE])
+#else
+#define DHT_PROFILE(sensor)     ((sensor)->profile)
+#endif
+
+// -----------------------------------------------------------------------------
+//                              Typedefs
+// -----------------------------------------------------------------------------
+
+struct dht_sensor
+{
+    const dht_profile_t *profile;
+    gpio_num_t pin;
+    esp_timer_handle_t timer;
+    SemaphoreHandle_t done;         /**< given when the frame is complete */
+    dht_edge_t edges[DHT_MAX_EDGES];  /**< cycle counter timestamps */
+    uint32_t ticks_per_us;          /**< CPU MHz when the capture started */
+    dht_pulse_stats_t stats;        /**< pulse widths of the last frame */
+    bool has_stats;
+    volatile uint8_t edge_count;
+    volatile uint8_t falling_count;
+#if DHT_ENABLE_STATS
+    int64_t request_us;             /**< esp_timer time of the start pulse */
+    volatile int64_t frame_end_us;  /**< esp_timer time of the last edge */
+    esp_err_t last_status;
+    dht_stats_t read_stats;
+#endif
+}; /**< state of one dht sensor */
 
 // -----------------------------------------------------------------------------
 //                              Variables
 // -----------------------------------------------------------------------------
 
-static dht_type_t dht_type;
-static gpio_num_t dht_pin;
+/* adding a variant only takes a line here and a dht_type_t value */
+static const dht_profile_t dht_profiles[DHT_TYPE_MAX] = {
+    [DHT11]  = { "DHT11",  20000, 1000, dht_decode_dht11 },
+    [DHT22]  = { "DHT22",  1000,  2000, dht_decode_dht22 },
+    [DHT21]  = { "DHT21",  1000,  2000, dht_decode_dht22 },
+    [SI7021] = { "SI7021", 500,   2000, dht_decode_dht22 },
+};
+/* a late frame must not give the semaphore of a read that returned */
+static portMUX_TYPE dht_done_mux = portMUX_INITIALIZER_UNLOCKED;
+
+#if DHT_ENABLE_STATS
+/* upper bounds of the histogram buckets, the last bucket takes the rest */
+static const uint32_t dht_bucket_limit_us[DHT_STATS_BUCKETS - 1] = {
+    2000, 4000, 6000, 8000, 12000, 20000, 28000
+};
+static portMUX_TYPE dht_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+#endif
 
 // -----------------------------------------------------------------------------
 //                       Local Function Declarations
@@ -22,78 +83,293 @@ static gpio_num_t dht_pin;
 
 /***************************************************************************//**
  * @brief
- *  Send request signal to DHT sensor.
+ *  Get the length of the start pulse for the sensor type.
+ *
+ * @return
+ *  Return value is the start pulse length in microseconds.
+ *
+ ******************************************************************************/
+static uint32_t dht_start_pulse_us(dht_handle_t sensor);
+
+/***************************************************************************//**
+ * @brief
+ *  Get how long to wait for the start pulse and the frame.
+ *
+ * @return
+ *  Return value is the timeout in ticks.
+ *
+ ******************************************************************************/
+static TickType_t dht_capture_timeout(dht_handle_t sensor);
+
+/***************************************************************************//**
+ * @brief
+ *  Wait for the data line to reach a level, bounded by a cycle counter
+ *  deadline.
+ *
+ * @param pin
+ *  The data line.
+ * @param level
+ *  The level to wait for.
+ * @param timeout_us
+ *  The longest time to wait in microseconds.
+ *
+ * @return
+ *  Return value is true if the level was reached in time.
+ *
+ ******************************************************************************/
+static bool dht_wait_level(gpio_num_t pin, uint32_t level,
+                           uint32_t timeout_us);
+
+/***************************************************************************//**
+ * @brief
+ *  Arm the edge capture of a sensor, pull the data line low and start the
+ *  timer that ends the start pulse.
+ *
+ * @param done
+ *  Given by the edge interrupt when the frame is complete.
+ *
+ ******************************************************************************/
+static void send_request(dht_handle_t sensor,SemaphoreHandle_t done);
+
+/***************************************************************************//**
+ * @brief
+ *  Timer callback ending the start pulse: arm the edge capture and release
+ *  the data line so the sensor can answer.
+ *
+ ******************************************************************************/
+static void dht_release_line(void *arg);
+
+/***************************************************************************//**
+ * @brief
+ *  Edge interrupt handler, timestamps every edge of the data line.
  *
  ******************************************************************************/
-static void send_request(void);
+static void dht_isr_handler(void *arg);
 
 /***************************************************************************//**
  * @brief
- *  Wait for the response from the DHT sensor.
+ *  Count the result of one read and its duration. Compiles to nothing when
+ *  DHT_ENABLE_STATS is 0.
+ *
+ * @param sensor
+ *  The sensor handle.
+ * @param status
+ *  The result of the read.
+ * @param requested
+ *  Whether the start pulse was sent.
  *
  ******************************************************************************/
-static void wait_response(void);
+static void dht_stats_record(dht_handle_t sensor, esp_err_t status,
+                             bool requested);
 
 /***************************************************************************//**
  * @brief
- *  Read one byte from DHT sensor.
+ *  Stop the capture of a sensor and decode what was captured.
+ *
+ * @param sensor
+ *  The sensor handle.
+ * @param data
+ *  The humidity and temperature, only written on success.
  *
  * @return
- *  Return value is a byte of data.
+ *  Return value is the result of the read, see dht_read().
  *
  ******************************************************************************/
-static uint8_t dht_read_byte(void);
+static esp_err_t dht_finish(dht_handle_t sensor, dht_data_type_t *data);
 
 // -----------------------------------------------------------------------------
 //                       Local Function Definitions
 // -----------------------------------------------------------------------------
 
+/***************************************************************************//**
+ *  Get the length of the start pulse for the sensor type.
+ ******************************************************************************/
+static uint32_t dht_start_pulse_us(dht_handle_t sensor)
+{
+    return DHT_PROFILE(sensor)->start_pulse_us;
+}
+
+/***************************************************************************//**
+ *  Get how long to wait for the start pulse and the frame.
+ ******************************************************************************/
+static TickType_t dht_capture_timeout(dht_handle_t sensor)
+{
+    return pdMS_TO_TICKS(dht_start_pulse_us(sensor) / 1000
+                         + DHT_FRAME_TIMEOUT_MS) + 1;
+}
+
+/***************************************************************************//**
+ *  Wait for the data line to reach a level.
+ ******************************************************************************/
+static bool dht_wait_level(gpio_num_t pin, uint32_t level,
+                           uint32_t timeout_us)
+{
+    uint32_t start = esp_cpu_get_ccount();
+    uint32_t cycles = timeout_us * ets_get_cpu_frequency();
+
+    while(gpio_get_level(pin) != level)
+    {
+        if(esp_cpu_get_ccount() - start > cycles)
+            return false;
+    }
+    return true;
+}
+
 /***************************************************************************//**
  *  Send request signal to DHT sensor.
  ******************************************************************************/
-static void send_request(void)
+static void send_request(dht_handle_t sensor,SemaphoreHandle_t done)
+{
+    portENTER_CRITICAL(&dht_done_mux);
+    sensor->done = done;
+    portEXIT_CRITICAL(&dht_done_mux);
+    sensor->ticks_per_us = ets_get_cpu_frequency();
+    sensor->edge_count = 0;
+    sensor->falling_count = 0;
+#if DHT_ENABLE_STATS
+    /* the cycle counter is per core, the ISR may run on the other one */
+    sensor->request_us = esp_timer_get_time();
+#endif
+
+    gpio_set_level(sensor->pin,0);
+    esp_timer_start_once(sensor->timer,dht_start_pulse_us(sensor));
+}
+
+/***************************************************************************//**
+ *  End the start pulse.
+ ******************************************************************************/
+static void dht_release_line(void *arg)
+{
+    dht_handle_t sensor = arg;
+
+    gpio_intr_enable(sensor->pin);
+    gpio_set_level(sensor->pin,1);
+}
+
+/***************************************************************************//**
+ *  Edge interrupt handler.
+ ******************************************************************************/
+static void IRAM_ATTR dht_isr_handler(void *arg)
 {
-    gpio_set_direction(dht_pin,GPIO_MODE_OUTPUT);
-    gpio_set_level(dht_pin,0);
-    if(dht_type == DHT11)
+    dht_handle_t sensor = arg;
+    BaseType_t woken = pdFALSE;
+    uint32_t now = esp_cpu_get_ccount();
+    uint8_t level = gpio_get_level(sensor->pin);
+    uint8_t n = sensor->edge_count;
+
+    if(n < DHT_MAX_EDGES)
     {
-        ets_delay_us(20000);
+        sensor->edges[n].time = now;
+        sensor->edges[n].level = level;
+        sensor->edge_count = n + 1;
     }
-    if(dht_type == DHT22)
+    /* response, 40 bits and the closing low: the frame is complete */
+    if(!level && (++sensor->falling_count == DHT_FRAME_PULSES + 1))
     {
-        ets_delay_us(1000);
+#if DHT_ENABLE_STATS
+        sensor->frame_end_us = esp_timer_get_time();
+#endif
+        portENTER_CRITICAL_ISR(&dht_done_mux);
+        if(sensor->done != NULL)
+            xSemaphoreGiveFromISR(sensor->done, &woken);
+        portEXIT_CRITICAL_ISR(&dht_done_mux);
+        portYIELD_FROM_ISR(woken);
     }
-    gpio_set_level(dht_pin,1);
-    ets_delay_us(30);
 }
 
 /***************************************************************************//**
- *  Wait for the response from the DHT sensor.
+ *  Count the result of one read.
  ******************************************************************************/
-static void wait_response(void)
+static void dht_stats_record(dht_handle_t sensor, esp_err_t status,
+                             bool requested)
 {
-    gpio_set_direction(dht_pin,GPIO_MODE_INPUT);
-    while(!gpio_get_level(dht_pin));
-    while(gpio_get_level(dht_pin));
+#if DHT_ENABLE_STATS
+    dht_stats_t *st = &sensor->read_stats;
+    int64_t end_us = esp_timer_get_time();
+    uint32_t duration_us;
+    uint8_t bucket = 0;
+
+    /* a complete frame ended at its last edge, the caller may wake later */
+    if((status == ESP_OK) || (status == DHT_ERR_CHECKSUM))
+        end_us = sensor->frame_end_us;
+    duration_us = end_us - sensor->request_us;
+    while((bucket < DHT_STATS_BUCKETS - 1)
+          && (duration_us >= dht_bucket_limit_us[bucket]))
+        bucket++;
+
+    portENTER_CRITICAL(&dht_stats_mux);
+    if(sensor->last_status != ESP_OK)
+        st->after_failure++;
+    sensor->last_status = status;
+    switch(status)
+    {
+        case ESP_OK:
+            st->success++;
+            break;
+        case DHT_ERR_CHECKSUM:
+            st->checksum++;
+            break;
+        case DHT_ERR_STUCK_LINE:
+            st->stuck_line++;
+            break;
+        case DHT_ERR_NO_RESPONSE:
+            st->no_response++;
+            break;
+        default:
+            st->timeout++;
+            break;
+    }
+    if(requested)
+    {
+        st->histogram[bucket]++;
+        if(duration_us > st->duration_max_us)
+            st->duration_max_us = duration_us;
+    }
+    portEXIT_CRITICAL(&dht_stats_mux);
+#else
+    (void)sensor;
+    (void)status;
+    (void)requested;
+#endif
 }
 
 /***************************************************************************//**
- *  Read one byte from DHT sensor.
+ *  Stop the capture of a sensor and decode it.
  ******************************************************************************/
-static uint8_t dht_read_byte(void)
+static esp_err_t dht_finish(dht_handle_t sensor, dht_data_type_t *data)
 {
-    uint8_t value = 0;
-    for(uint8_t i = 0; i < 8; i++)
+    dht_pulse_t pulse[DHT_FRAME_PULSES];
+    uint8_t frame[DHT_FRAME_BYTES];
+    dht_decode_status_t status;
+    size_t count;
+
+    esp_timer_stop(sensor->timer);
+    gpio_intr_disable(sensor->pin);
+    gpio_set_level(sensor->pin,1);
+
+    count = dht_edges_to_pulses(sensor->edges, sensor->edge_count,
+                                sensor->ticks_per_us,
+                                pulse, DHT_FRAME_PULSES);
+    status = dht_decode_pulses(pulse, count, frame, &sensor->stats);
+    if(count == DHT_FRAME_PULSES)
+        sensor->has_stats = true;
+    switch(status)
     {
-        while(!gpio_get_level(dht_pin));
-        ets_delay_us(30);
-        if(gpio_get_level(dht_pin))
-            value = (value<<1) | 0x01;
-        else
-            value = value<<1;
-    while(gpio_get_level(dht_pin));
+        case DHT_DECODE_OK:
+            break;
+        case DHT_DECODE_NO_RESPONSE:
+            /* line released by us but still low: something holds it */
+            if(!gpio_get_level(sensor->pin))
+                return DHT_ERR_STUCK_LINE;
+            return DHT_ERR_NO_RESPONSE;
+        case DHT_DECODE_SHORT_FRAME:
+            return DHT_ERR_TIMEOUT;
+        default:
+            return DHT_ERR_CHECKSUM;
     }
-    return value;
+
+    DHT_PROFILE(sensor)->decode(frame, data);
+    return ESP_OK;
 }
 
 // -----------------------------------------------------------------------------
@@ -101,73 +377,223 @@ static uint8_t dht_read_byte(void)
 // -----------------------------------------------------------------------------
 
 /***************************************************************************//**
- *  Initialize the configuration for the DHT sensor.
+ *  Profile of a sensor type.
+ ******************************************************************************/
+const dht_profile_t *dht_get_profile(dht_type_t type)
+{
+    if((unsigned)type >= DHT_TYPE_MAX)
+        return NULL;
+    return &dht_profiles[type];
+}
+
+/***************************************************************************//**
+ *  Create a handle for one DHT sensor.
+ ******************************************************************************/
+dht_handle_t dht_create(dht_type_t type,gpio_num_t pin)
+{
+    dht_handle_t sensor;
+    esp_timer_create_args_t timer_args = {
+        .callback = dht_release_line,
+        .name = "dht",
+    };
+    esp_err_t status;
+
+#ifdef DHT_FIXED_TYPE
+    if(type != DHT_FIXED_TYPE)
+        return NULL;
+#endif
+    if(dht_get_profile(type) == NULL)
+        return NULL;
+    sensor = calloc(1, sizeof(*sensor));
+    if(sensor == NULL)
+        return NULL;
+    sensor->profile = dht_get_profile(type);
+    sensor->pin  = pin;
+    timer_args.arg = sensor;
+    if(esp_timer_create(&timer_args,&sensor->timer) != ESP_OK)
+    {
+        free(sensor);
+        return NULL;
+    }
+
+    /* open drain: level 0 drives the line low, level 1 releases it */
+    gpio_set_direction(pin,GPIO_MODE_INPUT_OUTPUT_OD);
+    gpio_set_pull_mode(pin,GPIO_PULLUP_ONLY);
+    gpio_set_level(pin,1);
+
+    gpio_set_intr_type(pin,GPIO_INTR_ANYEDGE);
+    gpio_intr_disable(pin);
+    status = gpio_install_isr_service(0);
+    if((status == ESP_OK) || (status == ESP_ERR_INVALID_STATE))
+        status = gpio_isr_handler_add(pin,dht_isr_handler,sensor);
+    if(status != ESP_OK)
+    {
+        esp_timer_delete(sensor->timer);
+        free(sensor);
+        return NULL;
+    }
+    return sensor;
+}
+
+/***************************************************************************//**
+ *  Release a sensor handle.
  ******************************************************************************/
-void dht_init(dht_type_t type,gpio_num_t pin)
+void dht_delete(dht_handle_t sensor)
 {
-    dht_type = type;
-    dht_pin  = pin;
+    if(sensor == NULL)
+        return;
+    gpio_intr_disable(sensor->pin);
+    gpio_isr_handler_remove(sensor->pin);
+    esp_timer_stop(sensor->timer);
+    esp_timer_delete(sensor->timer);
+    free(sensor);
 }
 
 /***************************************************************************//**
  *  Read the humidity and temperature from the sensor.
  ******************************************************************************/
-dht_data_type_t dht_read(void)
+esp_err_t dht_read(dht_handle_t sensor,dht_data_type_t *data)
 {
-    dht_data_type_t value;
-    uint8_t data[5];
-    uint8_t sum;
+    return dht_read_group(&sensor, 1, data, NULL);
+}
 
-    send_request();
-    wait_response();
+/***************************************************************************//**
+ *  Read several sensors at once.
+ ******************************************************************************/
+esp_err_t dht_read_group(const dht_handle_t *sensor,size_t count,
+                         dht_data_type_t *data,esp_err_t *result)
+{
+    StaticSemaphore_t done_buffer;
+    SemaphoreHandle_t done;
+    esp_err_t first = ESP_OK;
+    esp_err_t status;
+    TickType_t timeout = 0;
+    TickType_t start;
+    uint32_t pending = 0;
 
-    if(dht_type == DHT22)
+    for(size_t i = 0; i < count; i++)
     {
-        for(uint8_t i = 0; i < 5; i++)
-        {
-            data[i] = dht_read_byte();
-        }
+        if(sensor[i] == NULL)
+            return ESP_ERR_INVALID_ARG;
+    }
+    if(count == 0)
+        return ESP_OK;
 
-        sum = data[0]+data[1]+data[2]+data[3];
+    /* one semaphore per call, the caller's task notifications are its own */
+    done = xSemaphoreCreateCountingStatic(count, 0, &done_buffer);
 
-        if(sum == data[4])
+    /* all start pulses go out back to back, the frames overlap */
+    for(size_t i = 0; i < count; i++)
+    {
+        if(!dht_wait_level(sensor[i]->pin, 1, DHT_IDLE_TIMEOUT_US))
         {
-            value.check_sum = true;
-            if(data[2] > 127)
-                value.temp = (float)data[3]/10*(-1);
-            else
-                value.temp = (float)((data[2]<<8)|data[3])/10;
-            value.humid = (float)((data[0]<<8)|data[1])/10;
+            portENTER_CRITICAL(&dht_done_mux);
+            sensor[i]->done = NULL;
+            portEXIT_CRITICAL(&dht_done_mux);
+            continue;
         }
-        else
-            value = (dht_data_type_t){0,0,false};
+        send_request(sensor[i], done);
+        if(dht_capture_timeout(sensor[i]) > timeout)
+            timeout = dht_capture_timeout(sensor[i]);
+        pending++;
     }
-    else if(dht_type == DHT11)
+
+    /* every complete frame gives the semaphore once */
+    start = xTaskGetTickCount();
+    while(pending > 0)
     {
-        for(int i=0;i<5;i++)
-        {
-            data[i] = dht_read_byte();
-        }
-        sum = data[0]+data[1]+data[2]+data[3];
+        TickType_t elapsed = xTaskGetTickCount() - start;
 
-        if(data[4] == sum)
-        {
-            value.humid = data[0];
-            value.temp = data[2];
-            for(int i=0;i<8;i++)
-            {
-                value.temp += ((data[3]>>(7-i))&0x01) * (float)pow(10,-(i+1));
-                value.humid +=  ((data[1]>>(7-i))&0x01) * (float)pow(10,-(i+1));
-            }
-            value.check_sum = true;
-        }
+        if((elapsed >= timeout)
+           || (xSemaphoreTake(done, timeout - elapsed) != pdTRUE))
+            break;
+        pending--;
+    }
+
+    for(size_t i = 0; i < count; i++)
+    {
+        bool requested;
+
+        portENTER_CRITICAL(&dht_done_mux);
+        requested = (sensor[i]->done != NULL);
+        sensor[i]->done = NULL;
+        portEXIT_CRITICAL(&dht_done_mux);
+
+        if(!requested)
+            status = DHT_ERR_STUCK_LINE;
         else
-        {
-            value = (dht_data_type_t){0,0,false};
-        }
+            status = dht_finish(sensor[i], &data[i]);
+        dht_stats_record(sensor[i], status, requested);
+        if(result != NULL)
+            result[i] = status;
+        if(first == ESP_OK)
+            first = status;
     }
-    return value;
+    vSemaphoreDelete(done);
+    return first;
+}
+
+/***************************************************************************//**
+ *  Worst-case duration of dht_read().
+ ******************************************************************************/
+uint32_t dht_max_read_latency_us(dht_handle_t sensor)
+{
+    return DHT_IDLE_TIMEOUT_US
+           + dht_capture_timeout(sensor) * portTICK_PERIOD_MS * 1000;
+}
+
+/***************************************************************************//**
+ *  Minimum time between two reads of a sensor.
+ ******************************************************************************/
+uint32_t dht_min_interval_ms(dht_handle_t sensor)
+{
+    return DHT_PROFILE(sensor)->min_interval_ms;
+}
+
+/***************************************************************************//**
+ *  Pulse widths of the last complete frame.
+ ******************************************************************************/
+esp_err_t dht_get_pulse_stats(dht_handle_t sensor,dht_pulse_stats_t *stats)
+{
+    if(!sensor->has_stats)
+        return ESP_ERR_INVALID_STATE;
+    *stats = sensor->stats;
+    return ESP_OK;
 }
+
+/***************************************************************************//**
+ *  Read statistics of a sensor.
+ ******************************************************************************/
+esp_err_t dht_get_stats(dht_handle_t sensor,dht_stats_t *stats)
+{
+#if DHT_ENABLE_STATS
+    portENTER_CRITICAL(&dht_stats_mux);
+    *stats = sensor->read_stats;
+    portEXIT_CRITICAL(&dht_stats_mux);
+    return ESP_OK;
+#else
+    (void)sensor;
+    (void)stats;
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+/***************************************************************************//**
+ *  Clear the read statistics of a sensor.
+ ******************************************************************************/
+esp_err_t dht_reset_stats(dht_handle_t sensor)
+{
+#if DHT_ENABLE_STATS
+    portENTER_CRITICAL(&dht_stats_mux);
+    memset(&sensor->read_stats, 0, sizeof(sensor->read_stats));
+    portEXIT_CRITICAL(&dht_stats_mux);
+    return ESP_OK;
+#else
+    (void)sensor;
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
 // -----------------------------------------------------------------------------
 //                              EOF
 // -----------------------------------------------------------------------------
@@ -7,6 +7,35 @@
 #ifndef _DHT_H_
 #define _DHT_H_
 
+// -----------------------------------------------------------------------------
+//                              Includes
+// -----------------------------------------------------------------------------
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+#include "dht_decode.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros
+// -----------------------------------------------------------------------------
+
+#define DHT_ERR_BASE            0x7100
+#define DHT_ERR_NO_RESPONSE     (DHT_ERR_BASE + 1) /**< sensor never answered */
+#define DHT_ERR_STUCK_LINE      (DHT_ERR_BASE + 2) /**< data line held low */
+#define DHT_ERR_TIMEOUT         (DHT_ERR_BASE + 3) /**< frame incomplete */
+#define DHT_ERR_CHECKSUM        (DHT_ERR_BASE + 4) /**< checksum mismatch */
+
+#ifndef DHT_ENABLE_STATS
+#define DHT_ENABLE_STATS        1       /**< 0 removes the read statistics */
+#endif
+#define DHT_STATS_BUCKETS       8       /**< read duration histogram size */
+
+/* Define DHT_FIXED_TYPE to one dht_type_t value to build the driver for that
+   sensor only: the profile becomes a constant and the decoder is called
+   directly, dht_create() rejects other types. */
+
 // -----------------------------------------------------------------------------
 //                              Typedefs
 // -----------------------------------------------------------------------------
@@ -14,15 +43,40 @@
 typedef enum
 {
     DHT11 = 0,
-    DHT22 = 1
+    DHT22 = 1,
+    DHT21 = 2,
+    SI7021 = 3,             /**< Si7021 behind a DHT protocol bridge */
+    DHT_TYPE_MAX,
+    AM2302 = DHT22,
+    AM2301 = DHT21
 }dht_type_t; /**< dht type definition */
 
 typedef struct
 {
-    float temp;
-    float humid;
-    uint8_t check_sum;
-}dht_data_type_t; /**< dht data type definition */
+    const char *name;
+    uint32_t start_pulse_us;    /**< how long the host holds the line low */
+    uint32_t min_interval_ms;   /**< shortest time between two reads */
+    void (*decode)(const uint8_t data[DHT_FRAME_BYTES],
+                   dht_reading_t *reading); /**< frame to tenths */
+}dht_profile_t; /**< timing and data encoding of one sensor type */
+
+typedef dht_reading_t dht_data_type_t; /**< dht data in tenths */
+
+typedef struct dht_sensor *dht_handle_t; /**< handle of one dht sensor */
+
+typedef struct
+{
+    uint32_t success;       /**< frames read and checked */
+    uint32_t checksum;      /**< complete frames with a bad checksum */
+    uint32_t stuck_line;    /**< line low before the request or after it */
+    uint32_t no_response;   /**< no response pulse after the request */
+    uint32_t timeout;       /**< frame stopped before 40 bits */
+    uint32_t after_failure; /**< reads following a failed read of the sensor,
+                                 the driver itself never retries */
+    uint32_t duration_max_us; /**< longest read */
+    uint32_t histogram[DHT_STATS_BUCKETS]; /**< reads by duration: below 2,
+                                  4, 6, 8, 12, 20, 28 ms and the rest */
+}dht_stats_t; /**< read statistics of one sensor */
 
 // -----------------------------------------------------------------------------
 //                       Public Function Declarations
@@ -30,25 +84,176 @@ typedef struct
 
 /***************************************************************************//**
  * @brief
- *  This function initialize the configuration for the DHT sensor.
+ *  This function give the profile of a sensor type.
  *
  * @param type
- *  The type of DHT sensor. It can be DHT11 or DHT22.
+ *  The type of DHT sensor.
+ *
+ * @return
+ *  Return value is the profile, NULL for an unknown type.
+ *
+ ******************************************************************************/
+const dht_profile_t *dht_get_profile(dht_type_t type);
+
+/***************************************************************************//**
+ * @brief
+ *  This function create a handle for one DHT sensor. The pin is set to open
+ *  drain with pull-up and its edges are captured by a GPIO interrupt, the
+ *  GPIO ISR service is installed if needed.
+ *
+ * @param type
+ *  The type of DHT sensor, see dht_type_t.
  * @param pin
  *  The GPIO pin that connected to the data pin of the sensor.
  *
+ * @return
+ *  Return value is the sensor handle, NULL if the type is unknown (or not
+ *  DHT_FIXED_TYPE), out of memory or the pin cannot be configured.
+ *
+ ******************************************************************************/
+dht_handle_t dht_create(dht_type_t type,gpio_num_t pin);
+
+/***************************************************************************//**
+ * @brief
+ *  This function release a sensor handle and its pin interrupt. A sensor
+ *  registered with the sampler must be removed with dht_sampler_remove()
+ *  first.
+ *
+ * @param sensor
+ *  The sensor handle, NULL is ignored.
+ *
+ ******************************************************************************/
+void dht_delete(dht_handle_t sensor);
+
+/***************************************************************************//**
+ * @brief
+ *  This function read the humidity and temperature from the sensor. The
+ *  start pulse is timed by an esp_timer and the calling task blocks on a
+ *  semaphore until the frame is captured, so it does not use the CPU
+ *  during the 1-20 ms request. The task notifications of the caller are
+ *  left alone. The call never takes longer than dht_max_read_latency_us().
+ *
+ * @param sensor
+ *  The sensor handle.
+ * @param data
+ *  The humidity and temperature, only written on success.
+ *
+ * @return
+ *  ESP_OK              if OK.
+ *  DHT_ERR_STUCK_LINE  if the data line is held low.
+ *  DHT_ERR_NO_RESPONSE if the sensor did not answer the request.
+ *  DHT_ERR_TIMEOUT     if the frame stopped before 40 bits.
+ *  DHT_ERR_CHECKSUM    if the checksum of the frame does not match.
+ *
  ******************************************************************************/
-void dht_init(dht_type_t type,gpio_num_t pin);
+esp_err_t dht_read(dht_handle_t sensor,dht_data_type_t *data);
 
 /***************************************************************************//**
  * @brief
- *  This function read the humidity and temperature from the sensor.
+ *  This function read several sensors at once. All start pulses are sent
+ *  together and the pulse trains are captured concurrently by the edge
+ *  interrupt of each pin, so the group takes about as long as its slowest
+ *  sensor. Sensors must be on different pins and the function must not be
+ *  called for the same sensor from two tasks at once.
+ *
+ * @param sensor
+ *  The sensor handles.
+ * @param count
+ *  The number of sensors.
+ * @param data
+ *  The humidity and temperature of each sensor, written for the sensors
+ *  read successfully.
+ * @param result
+ *  The result of each sensor as returned by dht_read(), may be NULL.
+ *
+ * @return
+ *  ESP_OK              if every sensor was read.
+ *  ESP_ERR_INVALID_ARG if a handle is NULL.
+ *  Other return code   the first failure, see result for each sensor.
+ *
+ ******************************************************************************/
+esp_err_t dht_read_group(const dht_handle_t *sensor,size_t count,
+                         dht_data_type_t *data,esp_err_t *result);
+
+/***************************************************************************//**
+ * @brief
+ *  This function give the worst-case duration of dht_read() for a sensor,
+ *  including the start pulse and tick rounding. A group read takes at most
+ *  the largest value of its sensors plus the idle check of the others.
+ *
+ * @param sensor
+ *  The sensor handle.
+ *
+ * @return
+ *  Return value is the worst-case read latency in microseconds.
+ *
+ ******************************************************************************/
+uint32_t dht_max_read_latency_us(dht_handle_t sensor);
+
+/***************************************************************************//**
+ * @brief
+ *  This function give the minimum time between two reads of a sensor, from
+ *  its profile. Reading faster returns stale or corrupted frames.
+ *
+ * @param sensor
+ *  The sensor handle.
+ *
+ * @return
+ *  Return value is the minimum read interval in milliseconds.
+ *
+ ******************************************************************************/
+uint32_t dht_min_interval_ms(dht_handle_t sensor);
+
+/***************************************************************************//**
+ * @brief
+ *  This function give the pulse widths of the last complete frame of a
+ *  sensor, including frames that failed the checksum. The gap between
+ *  zero_max_us, threshold_us and one_min_us shows the timing margin.
+ *
+ * @param sensor
+ *  The sensor handle.
+ * @param stats
+ *  The pulse widths.
+ *
+ * @return
+ *  ESP_OK                if OK.
+ *  ESP_ERR_INVALID_STATE if no complete frame was captured yet.
+ *
+ ******************************************************************************/
+esp_err_t dht_get_pulse_stats(dht_handle_t sensor,dht_pulse_stats_t *stats);
+
+/***************************************************************************//**
+ * @brief
+ *  This function give the read statistics of a sensor. The duration of a
+ *  read runs from the start pulse to the last edge of a complete frame, or
+ *  to the end of the wait for a failed one; reads that found the line stuck
+ *  before the request are only counted.
+ *
+ * @param sensor
+ *  The sensor handle.
+ * @param stats
+ *  The statistics.
+ *
+ * @return
+ *  ESP_OK                if OK.
+ *  ESP_ERR_NOT_SUPPORTED if DHT_ENABLE_STATS is 0.
+ *
+ ******************************************************************************/
+esp_err_t dht_get_stats(dht_handle_t sensor,dht_stats_t *stats);
+
+/***************************************************************************//**
+ * @brief
+ *  This function clear the read statistics of a sensor.
+ *
+ * @param sensor
+ *  The sensor handle.
  *
  * @return
- *  Return value is a struct that containing humidity and temperature.
+ *  ESP_OK                if OK.
+ *  ESP_ERR_NOT_SUPPORTED if DHT_ENABLE_STATS is 0.
  *
  ******************************************************************************/
-dht_data_type_t dht_read(void);
+esp_err_t dht_reset_stats(dht_handle_t sensor);
 
 #endif /* _DHT_H_ */
 
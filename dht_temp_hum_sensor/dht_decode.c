@@ -0,0 +1,142 @@
+// -----------------------------------------------------------------------------
+//                              Includes
+// -----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <string.h>
+#include "dht_decode.h"
+
+// -----------------------------------------------------------------------------
+//                       Public Function Definitions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Turn captured edges into low/high pulse pairs.
+ ******************************************************************************/
+size_t dht_edges_to_pulses(const dht_edge_t *edge, size_t edge_count,
+                           uint32_t ticks_per_us,
+                           dht_pulse_t *pulse, size_t max_pulses)
+{
+    size_t count = 0;
+    size_t i = 0;
+
+    while((i < edge_count) && edge[i].level)
+        i++;
+
+    for(; (i + 2 < edge_count) && (count < max_pulses); i += 2)
+    {
+        if(edge[i].level || !edge[i + 1].level || edge[i + 2].level)
+            break;
+        pulse[count].low_us  = (edge[i + 1].time - edge[i].time)
+                               / ticks_per_us;
+        pulse[count].high_us = (edge[i + 2].time - edge[i + 1].time)
+                               / ticks_per_us;
+        count++;
+    }
+    return count;
+}
+
+/***************************************************************************//**
+ *  Get the bit threshold for a frame from its response pulse.
+ ******************************************************************************/
+uint16_t dht_bit_threshold_us(const dht_pulse_t *response)
+{
+    uint32_t threshold = response->high_us * 6u / 10u;
+
+    if(threshold < DHT_THRESHOLD_MIN_US)
+        return DHT_THRESHOLD_MIN_US;
+    if(threshold > DHT_THRESHOLD_MAX_US)
+        return DHT_THRESHOLD_MAX_US;
+    return threshold;
+}
+
+/***************************************************************************//**
+ *  Decode a dht pulse train.
+ ******************************************************************************/
+dht_decode_status_t dht_decode_pulses(const dht_pulse_t *pulse,
+                                      size_t pulse_count,
+                                      uint8_t data[DHT_FRAME_BYTES],
+                                      dht_pulse_stats_t *stats)
+{
+    dht_pulse_stats_t s = {
+        .zero_min_us = UINT16_MAX,
+        .one_min_us = UINT16_MAX,
+    };
+    uint16_t threshold;
+    uint8_t sum;
+
+    if(pulse_count == 0)
+        return DHT_DECODE_NO_RESPONSE;
+    if(pulse_count < DHT_FRAME_PULSES)
+        return DHT_DECODE_SHORT_FRAME;
+
+    threshold = dht_bit_threshold_us(&pulse[0]);
+    memset(data, 0, DHT_FRAME_BYTES);
+    for(uint8_t i = 0; i < DHT_FRAME_BITS; i++)
+    {
+        uint16_t high = pulse[i + 1].high_us;
+
+        if(pulse[i + 1].low_us > s.low_max_us)
+            s.low_max_us = pulse[i + 1].low_us;
+        if(high > threshold)
+        {
+            data[i / 8] |= 0x80 >> (i % 8);
+            if(high < s.one_min_us)
+                s.one_min_us = high;
+            if(high > s.one_max_us)
+                s.one_max_us = high;
+        }
+        else
+        {
+            if(high < s.zero_min_us)
+                s.zero_min_us = high;
+            if(high > s.zero_max_us)
+                s.zero_max_us = high;
+        }
+    }
+
+    if(stats != NULL)
+    {
+        if(s.zero_min_us == UINT16_MAX)
+            s.zero_min_us = 0;
+        if(s.one_min_us == UINT16_MAX)
+            s.one_min_us = 0;
+        s.response_low_us = pulse[0].low_us;
+        s.response_high_us = pulse[0].high_us;
+        s.threshold_us = threshold;
+        *stats = s;
+    }
+
+    sum = data[0] + data[1] + data[2] + data[3];
+    if(sum != data[4])
+        return DHT_DECODE_CHECKSUM;
+    return DHT_DECODE_OK;
+}
+
+/***************************************************************************//**
+ *  Convert a DHT11 frame.
+ ******************************************************************************/
+void dht_decode_dht11(const uint8_t data[DHT_FRAME_BYTES],
+                      dht_reading_t *reading)
+{
+    int16_t temp = data[2] * 10 + (data[3] & 0x7F);
+
+    reading->humid = data[0] * 10 + data[1];
+    reading->temp = (data[3] & 0x80) ? -temp : temp;
+}
+
+/***************************************************************************//**
+ *  Convert a DHT22 frame.
+ ******************************************************************************/
+void dht_decode_dht22(const uint8_t data[DHT_FRAME_BYTES],
+                      dht_reading_t *reading)
+{
+    int16_t temp = ((data[2] & 0x7F) << 8) | data[3];
+
+    reading->humid = (data[0] << 8) | data[1];
+    reading->temp = (data[2] & 0x80) ? -temp : temp;
+}
+
+// -----------------------------------------------------------------------------
+//                              EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,195 @@
+/******************************************************************************
+*@file: dht_decode.h
+*@brief: pulse train decoder for dht sensor, free of ESP-IDF dependencies
+*******************************************************************************/
+#ifndef _DHT_DECODE_H_
+#define _DHT_DECODE_H_
+
+// -----------------------------------------------------------------------------
+//                              Includes
+// -----------------------------------------------------------------------------
+
+#include <stddef.h>
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+//                              Macros
+// -----------------------------------------------------------------------------
+
+#define DHT_FRAME_BYTES         5       /**< bytes in one dht frame */
+#define DHT_FRAME_BITS          40      /**< bits in one dht frame */
+#define DHT_FRAME_PULSES        (DHT_FRAME_BITS + 1) /**< response + bits */
+#define DHT_THRESHOLD_MIN_US    35      /**< lowest adaptive threshold */
+#define DHT_THRESHOLD_MAX_US    60      /**< highest adaptive threshold */
+
+// -----------------------------------------------------------------------------
+//                              Typedefs
+// -----------------------------------------------------------------------------
+
+typedef struct
+{
+    uint32_t time;
+    uint8_t level;
+}dht_edge_t; /**< line level after an edge and when it happened, in ticks */
+
+typedef struct
+{
+    uint16_t low_us;
+    uint16_t high_us;
+}dht_pulse_t; /**< one low period followed by one high period */
+
+typedef struct
+{
+    uint16_t response_low_us;   /**< low part of the response pulse */
+    uint16_t response_high_us;  /**< high part of the response pulse */
+    uint16_t threshold_us;      /**< high pulse longer than this is a 1 */
+    uint16_t zero_min_us;       /**< shortest high pulse of a 0 bit, 0 if
+                                     there was no 0 bit (same for 1) */
+    uint16_t zero_max_us;       /**< longest high pulse of a 0 bit */
+    uint16_t one_min_us;        /**< shortest high pulse of a 1 bit */
+    uint16_t one_max_us;        /**< longest high pulse of a 1 bit */
+    uint16_t low_max_us;        /**< longest low pulse before a bit */
+}dht_pulse_stats_t; /**< pulse widths of one decoded frame */
+
+typedef struct
+{
+    int16_t temp;           /**< temperature in tenths of a degree Celsius */
+    uint16_t humid;         /**< relative humidity in tenths of a percent */
+}dht_reading_t; /**< decoded frame, fixed point */
+
+typedef enum
+{
+    DHT_DECODE_OK = 0,
+    DHT_DECODE_NO_RESPONSE = 1,
+    DHT_DECODE_SHORT_FRAME = 2,
+    DHT_DECODE_CHECKSUM = 3
+}dht_decode_status_t; /**< result of decoding a pulse train */
+
+// -----------------------------------------------------------------------------
+//                       Public Function Declarations
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ * @brief
+ *  Turn captured edges into low/high pulse pairs, starting at the first
+ *  falling edge. Conversion stops at a missing edge (two edges with the
+ *  same level) or when the output is full. Edge times may wrap around.
+ *
+ * @param edge
+ *  The captured edges in time order.
+ * @param edge_count
+ *  The number of captured edges.
+ * @param ticks_per_us
+ *  The rate of the edge timestamps, e.g. the CPU frequency in MHz for the
+ *  cycle counter.
+ * @param pulse
+ *  The output pulses.
+ * @param max_pulses
+ *  The capacity of the output.
+ *
+ * @return
+ *  Return value is the number of complete pulses.
+ *
+ ******************************************************************************/
+size_t dht_edges_to_pulses(const dht_edge_t *edge, size_t edge_count,
+                           uint32_t ticks_per_us,
+                           dht_pulse_t *pulse, size_t max_pulses);
+
+/***************************************************************************//**
+ * @brief
+ *  Get the bit threshold for a frame from its response pulse. The sensor
+ *  times the 80 us response high and the 26/70 us bit highs with the same
+ *  clock, so 0.6 of the response sits between a 0 and a 1 whatever the
+ *  batch, cable or timestamp error. The result is clamped to
+ *  DHT_THRESHOLD_MIN_US..DHT_THRESHOLD_MAX_US.
+ *
+ * @param response
+ *  The response pulse.
+ *
+ * @return
+ *  Return value is the threshold in microseconds.
+ *
+ ******************************************************************************/
+uint16_t dht_bit_threshold_us(const dht_pulse_t *response);
+
+/***************************************************************************//**
+ * @brief
+ *  Decode a dht pulse train: the response pulse followed by 40 data bits.
+ *  Each bit is classified against dht_bit_threshold_us() of the response.
+ *
+ * @param pulse
+ *  The pulses, starting with the response pulse.
+ * @param pulse_count
+ *  The number of pulses.
+ * @param data
+ *  The decoded 5 bytes of the frame.
+ * @param stats
+ *  The pulse widths of the frame, may be NULL. Only written when the frame
+ *  is complete, even if its checksum does not match.
+ *
+ * @return
+ *  Return value is DHT_DECODE_OK if the frame is complete and its checksum
+ *  matches.
+ *
+ ******************************************************************************/
+dht_decode_status_t dht_decode_pulses(const dht_pulse_t *pulse,
+                                      size_t pulse_count,
+                                      uint8_t data[DHT_FRAME_BYTES],
+                                      dht_pulse_stats_t *stats);
+
+/***************************************************************************//**
+ * @brief
+ *  Convert a DHT11 frame. The integral and decimal bytes are whole units and
+ *  tenths; bit 7 of the temperature decimal byte marks a negative value on
+ *  the sensors that can measure below zero.
+ *
+ * @param data
+ *  The 5 bytes of a frame with a valid checksum.
+ * @param reading
+ *  The temperature and humidity in tenths.
+ *
+ ******************************************************************************/
+void dht_decode_dht11(const uint8_t data[DHT_FRAME_BYTES],
+                      dht_reading_t *reading);
+
+/***************************************************************************//**
+ * @brief
+ *  Convert a DHT22 frame. Humidity is a 16-bit count of tenths, temperature
+ *  is a 15-bit count of tenths with the sign in bit 15.
+ *
+ * @param data
+ *  The 5 bytes of a frame with a valid checksum.
+ * @param reading
+ *  The temperature and humidity in tenths.
+ *
+ ******************************************************************************/
+void dht_decode_dht22(const uint8_t data[DHT_FRAME_BYTES],
+                      dht_reading_t *reading);
+
+#ifndef DHT_NO_FLOAT
+/***************************************************************************//**
+ * @brief
+ *  Get the temperature of a reading in degrees Celsius.
+ *
+ ******************************************************************************/
+static inline float dht_reading_temp(const dht_reading_t *reading)
+{
+    return reading->temp / 10.0f;
+}
+
+/***************************************************************************//**
+ * @brief
+ *  Get the relative humidity of a reading in percent.
+ *
+ ******************************************************************************/
+static inline float dht_reading_humid(const dht_reading_t *reading)
+{
+    return reading->humid / 10.0f;
+}
+#endif /* DHT_NO_FLOAT */
+
+#endif /* _DHT_DECODE_H_ */
+
+// -----------------------------------------------------------------------------
+//                              EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,187 @@
+// -----------------------------------------------------------------------------
+//                              Includes
+// -----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "dht_filter.h"
+
+// -----------------------------------------------------------------------------
+//                       Local Function Declarations
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ * @brief
+ *  Find where a value goes in a sorted array.
+ *
+ * @return
+ *  Return value is the index of the first element not below the value.
+ *
+ ******************************************************************************/
+static uint8_t dht_filter_lower_bound(const int16_t *sorted, uint8_t count,
+                                      int16_t value);
+
+/***************************************************************************//**
+ * @brief
+ *  Push a sample into the median window and get the median.
+ *
+ ******************************************************************************/
+static int16_t dht_filter_median(dht_filter_channel_t *ch, uint8_t window,
+                                 int16_t sample);
+
+/***************************************************************************//**
+ * @brief
+ *  Run one sample of one quantity through the pipeline.
+ *
+ * @return
+ *  Return value is false if the sample was rejected.
+ *
+ ******************************************************************************/
+static bool dht_filter_channel(dht_filter_channel_t *ch,
+                               const dht_filter_config_t *config,
+                               uint16_t max_step, int16_t sample);
+
+// -----------------------------------------------------------------------------
+//                       Local Function Definitions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Find where a value goes in a sorted array.
+ ******************************************************************************/
+static uint8_t dht_filter_lower_bound(const int16_t *sorted, uint8_t count,
+                                      int16_t value)
+{
+    uint8_t lo = 0;
+    uint8_t hi = count;
+
+    while(lo < hi)
+    {
+        uint8_t mid = (lo + hi) / 2;
+
+        if(sorted[mid] < value)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/***************************************************************************//**
+ *  Push a sample into the median window.
+ ******************************************************************************/
+static int16_t dht_filter_median(dht_filter_channel_t *ch, uint8_t window,
+                                 int16_t sample)
+{
+    uint8_t pos;
+
+    if(ch->count == window)
+    {
+        /* drop the oldest sample from the sorted copy */
+        pos = dht_filter_lower_bound(ch->sorted, ch->count,
+                                     ch->ring[ch->head]);
+        memmove(&ch->sorted[pos], &ch->sorted[pos + 1],
+                (ch->count - pos - 1) * sizeof(int16_t));
+        ch->ring[ch->head] = sample;
+        ch->head = (ch->head + 1) % window;
+        ch->count--;
+    }
+    else
+    {
+        ch->ring[(ch->head + ch->count) % window] = sample;
+    }
+
+    pos = dht_filter_lower_bound(ch->sorted, ch->count, sample);
+    memmove(&ch->sorted[pos + 1], &ch->sorted[pos],
+            (ch->count - pos) * sizeof(int16_t));
+    ch->sorted[pos] = sample;
+    ch->count++;
+
+    if(ch->count & 1)
+        return ch->sorted[ch->count / 2];
+    return (ch->sorted[ch->count / 2 - 1] + ch->sorted[ch->count / 2]) / 2;
+}
+
+/***************************************************************************//**
+ *  Run one sample of one quantity through the pipeline.
+ ******************************************************************************/
+static bool dht_filter_channel(dht_filter_channel_t *ch,
+                               const dht_filter_config_t *config,
+                               uint16_t max_step, int16_t sample)
+{
+    int32_t value = sample;
+    int32_t step = (int32_t)sample - ch->last;
+
+    if(ch->primed && max_step && ((step > max_step) || (step < -max_step)))
+    {
+        /* a real step change persists, a glitch does not */
+        if((config->max_rejects == 0) || (++ch->rejects < config->max_rejects))
+            return false;
+    }
+    ch->rejects = 0;
+    ch->last = sample;
+
+    if(config->median_window > 1)
+        value = dht_filter_median(ch, config->median_window, sample);
+
+    if((config->ema_alpha_q8 > 0) && (config->ema_alpha_q8 < 256))
+    {
+        if(!ch->primed)
+            ch->ema_q8 = value * 256;
+        else
+            /* a full-scale step times alpha passes 32 bits */
+            ch->ema_q8 += (int32_t)(((int64_t)config->ema_alpha_q8
+                                     * (value * 256 - ch->ema_q8)) / 256);
+        value = (ch->ema_q8 + 128) >> 8;
+    }
+
+    ch->primed = true;
+    ch->value = value;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+//                       Public Function Definitions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Initialize a filter.
+ ******************************************************************************/
+void dht_filter_init(dht_filter_t *filter, const dht_filter_config_t *config)
+{
+    filter->config = *config;
+    if(filter->config.median_window > DHT_FILTER_MEDIAN_MAX)
+        filter->config.median_window = DHT_FILTER_MEDIAN_MAX;
+    dht_filter_reset(filter);
+}
+
+/***************************************************************************//**
+ *  Forget the history of a filter.
+ ******************************************************************************/
+void dht_filter_reset(dht_filter_t *filter)
+{
+    memset(&filter->temp, 0, sizeof(filter->temp));
+    memset(&filter->humid, 0, sizeof(filter->humid));
+}
+
+/***************************************************************************//**
+ *  Run one reading through the pipeline.
+ ******************************************************************************/
+bool dht_filter_update(dht_filter_t *filter, const dht_reading_t *in,
+                       dht_reading_t *out)
+{
+    bool temp_ok = dht_filter_channel(&filter->temp, &filter->config,
+                                      filter->config.temp_max_step,
+                                      in->temp);
+    bool humid_ok = dht_filter_channel(&filter->humid, &filter->config,
+                                       filter->config.humid_max_step,
+                                       (int16_t)in->humid);
+
+    out->temp = filter->temp.value;
+    out->humid = (uint16_t)filter->humid.value;
+    return temp_ok && humid_ok;
+}
+
+// -----------------------------------------------------------------------------
+//                              EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,109 @@
+/******************************************************************************
+*@file: dht_filter.h
+*@brief: incremental filters for dht readings: outlier rejection, sliding
+*        median and exponential moving average
+*******************************************************************************/
+#ifndef _DHT_FILTER_H_
+#define _DHT_FILTER_H_
+
+// -----------------------------------------------------------------------------
+//                              Includes
+// -----------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "dht_decode.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros
+// -----------------------------------------------------------------------------
+
+#define DHT_FILTER_MEDIAN_MAX   9       /**< largest median window */
+
+// -----------------------------------------------------------------------------
+//                              Typedefs
+// -----------------------------------------------------------------------------
+
+typedef struct
+{
+    uint16_t temp_max_step;     /**< largest temperature change between two
+                                     samples in tenths, 0 disables */
+    uint16_t humid_max_step;    /**< same for the humidity */
+    uint8_t max_rejects;        /**< consecutive rejects after which the new
+                                     level is accepted, 0 never accepts */
+    uint8_t median_window;      /**< median window, 0 or 1 disables */
+    uint16_t ema_alpha_q8;      /**< weight of a new sample in 1/256, 0 or
+                                     256 disables */
+}dht_filter_config_t; /**< filter pipeline of one sensor */
+
+typedef struct
+{
+    int16_t ring[DHT_FILTER_MEDIAN_MAX];    /**< samples in arrival order */
+    int16_t sorted[DHT_FILTER_MEDIAN_MAX];  /**< same samples, sorted */
+    uint8_t head;               /**< oldest sample in ring */
+    uint8_t count;              /**< samples in the window */
+    int32_t ema_q8;             /**< moving average, value << 8 */
+    int16_t last;               /**< last accepted raw sample */
+    int16_t value;              /**< last filtered value */
+    uint8_t rejects;            /**< consecutive rejected samples */
+    bool primed;                /**< a sample was accepted */
+}dht_filter_channel_t; /**< filter state of one quantity */
+
+typedef struct
+{
+    dht_filter_config_t config;
+    dht_filter_channel_t temp;
+    dht_filter_channel_t humid;
+}dht_filter_t; /**< filter state of one sensor */
+
+// -----------------------------------------------------------------------------
+//                       Public Function Declarations
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ * @brief
+ *  Initialize a filter. Each sensor needs its own filter.
+ *
+ * @param filter
+ *  The filter.
+ * @param config
+ *  The pipeline, median_window is limited to DHT_FILTER_MEDIAN_MAX.
+ *
+ ******************************************************************************/
+void dht_filter_init(dht_filter_t *filter, const dht_filter_config_t *config);
+
+/***************************************************************************//**
+ * @brief
+ *  Forget the history of a filter and keep its configuration.
+ *
+ * @param filter
+ *  The filter.
+ *
+ ******************************************************************************/
+void dht_filter_reset(dht_filter_t *filter);
+
+/***************************************************************************//**
+ * @brief
+ *  Run one reading through the pipeline: rate-of-change rejection, then the
+ *  sliding median, then the moving average. The cost does not depend on the
+ *  history, the median keeps a sorted copy of its window.
+ *
+ * @param filter
+ *  The filter.
+ * @param in
+ *  The raw reading.
+ * @param out
+ *  The filtered reading. A rejected quantity keeps its previous value.
+ *
+ * @return
+ *  Return value is false if the temperature or the humidity was rejected.
+ *
+ ******************************************************************************/
+bool dht_filter_update(dht_filter_t *filter, const dht_reading_t *in,
+                       dht_reading_t *out);
+
+#endif /* _DHT_FILTER_H_ */
+
+// -----------------------------------------------------------------------------
+//                              EOF
+// -----------------------------------------------------------------------------
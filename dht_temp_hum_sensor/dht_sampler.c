@@ -0,0 +1,331 @@
+// -----------------------------------------------------------------------------
+//                              Includes
+// -----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "dht.h"
+#include "dht_sampler.h"
+
+// -----------------------------------------------------------------------------
+//                              Typedefs
+// -----------------------------------------------------------------------------
+
+typedef struct
+{
+    dht_handle_t sensor;
+    int64_t interval_us;
+    int64_t next_us;                /**< when the sensor is due */
+    volatile uint32_t seq;          /**< odd while sample is being written */
+    dht_sample_t sample;
+    dht_filter_t filter;
+    bool filtered;                  /**< filter is configured */
+}dht_sampler_slot_t; /**< one registered sensor */
+
+// -----------------------------------------------------------------------------
+//                              Variables
+// -----------------------------------------------------------------------------
+
+static dht_sampler_slot_t sampler_slot[DHT_SAMPLER_MAX_SENSORS];
+static uint32_t sampler_count;
+static portMUX_TYPE sampler_mux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t sampler_task;
+static volatile bool sampler_stop;
+static volatile bool sampler_busy;  /**< task is reading the due sensors */
+
+// -----------------------------------------------------------------------------
+//                       Local Function Declarations
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ * @brief
+ *  Find the slot of a registered sensor.
+ *
+ * @return
+ *  Return value is the slot, NULL if the sensor is not registered.
+ *
+ ******************************************************************************/
+static dht_sampler_slot_t *dht_sampler_find(dht_handle_t sensor);
+
+/***************************************************************************//**
+ * @brief
+ *  Filter the result of one read and store it in a slot. The sampler task
+ *  is the only writer; the update runs in a critical section so a reader on
+ *  the same core never preempts it half way.
+ *
+ ******************************************************************************/
+static void dht_sampler_publish(dht_sampler_slot_t *slot, esp_err_t status,
+                                const dht_data_type_t *data, int64_t now);
+
+/***************************************************************************//**
+ * @brief
+ *  Sampler task, reads the sensors that are due and sleeps until the next
+ *  one is.
+ *
+ ******************************************************************************/
+static void dht_sampler_task(void *arg);
+
+// -----------------------------------------------------------------------------
+//                       Local Function Definitions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Find the slot of a registered sensor.
+ ******************************************************************************/
+static dht_sampler_slot_t *dht_sampler_find(dht_handle_t sensor)
+{
+    uint32_t count = __atomic_load_n(&sampler_count, __ATOMIC_ACQUIRE);
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        if(sampler_slot[i].sensor == sensor)
+            return &sampler_slot[i];
+    }
+    return NULL;
+}
+
+/***************************************************************************//**
+ *  Store the result of one read in a slot.
+ ******************************************************************************/
+static void dht_sampler_publish(dht_sampler_slot_t *slot, esp_err_t status,
+                                const dht_data_type_t *data, int64_t now)
+{
+    portENTER_CRITICAL(&sampler_mux);
+    slot->seq++;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->sample.status = status;
+    if(status == ESP_OK)
+    {
+        slot->sample.raw = *data;
+        if(!slot->filtered)
+        {
+            slot->sample.data = *data;
+            slot->sample.time_us = now;
+        }
+        else if(dht_filter_update(&slot->filter, data, &slot->sample.data))
+        {
+            slot->sample.time_us = now;
+        }
+    }
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->seq++;
+    portEXIT_CRITICAL(&sampler_mux);
+}
+
+/***************************************************************************//**
+ *  Sampler task.
+ ******************************************************************************/
+static void dht_sampler_task(void *arg)
+{
+    dht_handle_t due[DHT_SAMPLER_MAX_SENSORS];
+    dht_sampler_slot_t *due_slot[DHT_SAMPLER_MAX_SENSORS];
+    dht_data_type_t data[DHT_SAMPLER_MAX_SENSORS];
+    esp_err_t result[DHT_SAMPLER_MAX_SENSORS];
+
+    while(!sampler_stop)
+    {
+        int64_t now = esp_timer_get_time();
+        int64_t wake = now + DHT_SAMPLER_POLL_MS * 1000;
+        size_t n = 0;
+
+        /* the due sensors stay registered until sampler_busy is cleared */
+        portENTER_CRITICAL(&sampler_mux);
+        for(uint32_t i = 0; i < sampler_count; i++)
+        {
+            dht_sampler_slot_t *slot = &sampler_slot[i];
+
+            if(slot->next_us <= now)
+            {
+                /* failed reads wait too, the sensor needs the rest */
+                slot->next_us = now + slot->interval_us;
+                due_slot[n] = slot;
+                due[n++] = slot->sensor;
+            }
+            if(slot->next_us < wake)
+                wake = slot->next_us;
+        }
+        sampler_busy = (n > 0);
+        portEXIT_CRITICAL(&sampler_mux);
+
+        if(n > 0)
+        {
+            dht_read_group(due, n, data, result);
+            now = esp_timer_get_time();
+            for(size_t i = 0; i < n; i++)
+                dht_sampler_publish(due_slot[i], result[i], &data[i], now);
+            sampler_busy = false;
+        }
+
+        now = esp_timer_get_time();
+        if(wake > now)
+            vTaskDelay(pdMS_TO_TICKS((wake - now) / 1000) + 1);
+    }
+
+    sampler_task = NULL;
+    vTaskDelete(NULL);
+}
+
+// -----------------------------------------------------------------------------
+//                       Public Function Definitions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Register a sensor with the sampler.
+ ******************************************************************************/
+esp_err_t dht_sampler_add(dht_handle_t sensor,uint32_t interval_ms)
+{
+    dht_sampler_slot_t *slot;
+    esp_err_t status = ESP_OK;
+
+    if(sensor == NULL)
+        return ESP_ERR_INVALID_ARG;
+    if(interval_ms < dht_min_interval_ms(sensor))
+        interval_ms = dht_min_interval_ms(sensor);
+
+    portENTER_CRITICAL(&sampler_mux);
+    if(dht_sampler_find(sensor) != NULL)
+        status = ESP_ERR_INVALID_ARG;
+    else if(sampler_count == DHT_SAMPLER_MAX_SENSORS)
+        status = ESP_ERR_NO_MEM;
+    else
+    {
+        slot = &sampler_slot[sampler_count];
+        memset(slot, 0, sizeof(*slot));
+        slot->sensor = sensor;
+        slot->interval_us = (int64_t)interval_ms * 1000;
+        slot->sample.status = ESP_ERR_INVALID_STATE;
+        /* the slot is complete before the task can see it */
+        __atomic_store_n(&sampler_count, sampler_count + 1, __ATOMIC_RELEASE);
+    }
+    portEXIT_CRITICAL(&sampler_mux);
+    return status;
+}
+
+/***************************************************************************//**
+ *  Set the filter pipeline of a registered sensor.
+ ******************************************************************************/
+esp_err_t dht_sampler_set_filter(dht_handle_t sensor,
+                                 const dht_filter_config_t *config)
+{
+    dht_sampler_slot_t *slot;
+
+    portENTER_CRITICAL(&sampler_mux);
+    slot = dht_sampler_find(sensor);
+    if(slot != NULL)
+    {
+        slot->filtered = (config != NULL);
+        if(config != NULL)
+            dht_filter_init(&slot->filter, config);
+    }
+    portEXIT_CRITICAL(&sampler_mux);
+    return (slot != NULL) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+/***************************************************************************//**
+ *  Unregister a sensor from the sampler.
+ ******************************************************************************/
+esp_err_t dht_sampler_remove(dht_handle_t sensor)
+{
+    dht_sampler_slot_t *slot;
+    dht_sampler_slot_t *last;
+
+    /* wait out a read that may use the sensor, then hold the task off */
+    for(;;)
+    {
+        portENTER_CRITICAL(&sampler_mux);
+        if(!sampler_busy)
+            break;
+        portEXIT_CRITICAL(&sampler_mux);
+        vTaskDelay(pdMS_TO_TICKS(10) + 1);
+    }
+
+    slot = dht_sampler_find(sensor);
+    if(slot != NULL)
+    {
+        /* the last slot fills the hole, readers of either one retry */
+        last = &sampler_slot[sampler_count - 1];
+        if(slot != last)
+        {
+            slot->seq++;
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            slot->sensor = last->sensor;
+            slot->interval_us = last->interval_us;
+            slot->next_us = last->next_us;
+            slot->sample = last->sample;
+            slot->filter = last->filter;
+            slot->filtered = last->filtered;
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            slot->seq++;
+        }
+        __atomic_store_n(&sampler_count, sampler_count - 1, __ATOMIC_RELEASE);
+    }
+    portEXIT_CRITICAL(&sampler_mux);
+    return (slot != NULL) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+/***************************************************************************//**
+ *  Start the sampler task.
+ ******************************************************************************/
+esp_err_t dht_sampler_start(uint32_t stack_size,UBaseType_t priority)
+{
+    if(sampler_task != NULL)
+        return ESP_ERR_INVALID_STATE;
+
+    sampler_stop = false;
+    if(xTaskCreate(dht_sampler_task, "dht_sampler", stack_size, NULL,
+                   priority, &sampler_task) != pdPASS)
+    {
+        sampler_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+/***************************************************************************//**
+ *  Stop the sampler task.
+ ******************************************************************************/
+void dht_sampler_stop(void)
+{
+    sampler_stop = true;
+    while(sampler_task != NULL)
+        vTaskDelay(pdMS_TO_TICKS(10) + 1);
+}
+
+/***************************************************************************//**
+ *  Fetch the latest sample of a sensor.
+ ******************************************************************************/
+esp_err_t dht_sampler_get(dht_handle_t sensor,dht_sample_t *sample)
+{
+    dht_sampler_slot_t *slot = dht_sampler_find(sensor);
+    dht_handle_t owner;
+    uint32_t seq;
+
+    if(slot == NULL)
+        return ESP_ERR_NOT_FOUND;
+
+    /* retry if the sampler wrote the slot while it was copied */
+    do
+    {
+        seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        owner = slot->sensor;
+        *sample = slot->sample;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while((seq & 1)
+            || (seq != __atomic_load_n(&slot->seq, __ATOMIC_RELAXED)));
+
+    /* the sensor was removed and another one moved in */
+    if(owner != sensor)
+        return ESP_ERR_NOT_FOUND;
+
+    if(sample->time_us == 0)
+        return ESP_ERR_INVALID_STATE;
+    return ESP_OK;
+}
+
+// -----------------------------------------------------------------------------
+//                              EOF
+// -----------------------------------------------------------------------------
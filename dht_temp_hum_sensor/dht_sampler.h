@@ -0,0 +1,147 @@
+/******************************************************************************
+*@file: dht_sampler.h
+*@brief: background sampling of dht sensors with a cached latest reading
+*******************************************************************************/
+#ifndef _DHT_SAMPLER_H_
+#define _DHT_SAMPLER_H_
+
+// -----------------------------------------------------------------------------
+//                              Includes
+// -----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "dht.h"
+#include "dht_filter.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros
+// -----------------------------------------------------------------------------
+
+#define DHT_SAMPLER_MAX_SENSORS 8       /**< sensors one sampler can serve */
+#define DHT_SAMPLER_POLL_MS     100     /**< longest sleep of the task */
+
+// -----------------------------------------------------------------------------
+//                              Typedefs
+// -----------------------------------------------------------------------------
+
+typedef struct
+{
+    dht_data_type_t data;   /**< last successful reading, filtered */
+    dht_data_type_t raw;    /**< same reading before the filter */
+    int64_t time_us;        /**< esp_timer time of the last read that passed
+                                 the filter */
+    esp_err_t status;       /**< result of the most recent read */
+}dht_sample_t; /**< latest state of one sampled sensor */
+
+// -----------------------------------------------------------------------------
+//                       Public Function Declarations
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ * @brief
+ *  This function register a sensor with the sampler. It can be called before
+ *  or after dht_sampler_start(). The sampler owns the sensor from then on,
+ *  do not call dht_read() on it while the sampler runs.
+ *
+ * @param sensor
+ *  The sensor handle.
+ * @param interval_ms
+ *  The sampling period, raised to dht_min_interval_ms() if shorter. 0 uses
+ *  the minimum interval.
+ *
+ * @return
+ *  ESP_OK              if OK.
+ *  ESP_ERR_INVALID_ARG if the handle is NULL or already registered.
+ *  ESP_ERR_NO_MEM      if DHT_SAMPLER_MAX_SENSORS are registered.
+ *
+ ******************************************************************************/
+esp_err_t dht_sampler_add(dht_handle_t sensor,uint32_t interval_ms);
+
+/***************************************************************************//**
+ * @brief
+ *  This function set the filter pipeline of a registered sensor. Successful
+ *  reads go through it before they are published, outliers it rejects leave
+ *  the published value unchanged. The filter history starts over.
+ *
+ * @param sensor
+ *  The sensor handle.
+ * @param config
+ *  The pipeline, NULL publishes raw readings.
+ *
+ * @return
+ *  ESP_OK            if OK.
+ *  ESP_ERR_NOT_FOUND if the sensor is not registered.
+ *
+ ******************************************************************************/
+esp_err_t dht_sampler_set_filter(dht_handle_t sensor,
+                                 const dht_filter_config_t *config);
+
+/***************************************************************************//**
+ * @brief
+ *  This function unregister a sensor from the sampler. If the sampler task
+ *  is reading, it waits for the read to finish, so the sensor is not in use
+ *  when it returns. Call it before dht_delete() on a registered sensor.
+ *
+ * @param sensor
+ *  The sensor handle.
+ *
+ * @return
+ *  ESP_OK            if OK.
+ *  ESP_ERR_NOT_FOUND if the sensor is not registered.
+ *
+ ******************************************************************************/
+esp_err_t dht_sampler_remove(dht_handle_t sensor);
+
+/***************************************************************************//**
+ * @brief
+ *  This function start the sampler task. Sensors that are due at the same
+ *  time are read together with dht_read_group().
+ *
+ * @param stack_size
+ *  The stack size of the task in bytes.
+ * @param priority
+ *  The priority of the task.
+ *
+ * @return
+ *  ESP_OK                if OK.
+ *  ESP_ERR_INVALID_STATE if the sampler is already running.
+ *  ESP_ERR_NO_MEM        if the task cannot be created.
+ *
+ ******************************************************************************/
+esp_err_t dht_sampler_start(uint32_t stack_size,UBaseType_t priority);
+
+/***************************************************************************//**
+ * @brief
+ *  This function stop the sampler task and wait for it to exit, at most one
+ *  read plus DHT_SAMPLER_POLL_MS. Registered sensors and their last samples
+ *  are kept.
+ *
+ ******************************************************************************/
+void dht_sampler_stop(void);
+
+/***************************************************************************//**
+ * @brief
+ *  This function fetch the latest sample of a sensor without touching the
+ *  bus. It never blocks on the sampler, so it can be called from any task.
+ *
+ * @param sensor
+ *  The sensor handle.
+ * @param sample
+ *  The latest sample.
+ *
+ * @return
+ *  ESP_OK                if OK, sample->status tells if the latest read
+ *                        failed and sample->data is older.
+ *  ESP_ERR_NOT_FOUND     if the sensor is not registered.
+ *  ESP_ERR_INVALID_STATE if the sensor was not read successfully yet.
+ *
+ ******************************************************************************/
+esp_err_t dht_sampler_get(dht_handle_t sensor,dht_sample_t *sample);
+
+#endif /* _DHT_SAMPLER_H_ */
+
+// -----------------------------------------------------------------------------
+//                              EOF
+// -----------------------------------------------------------------------------
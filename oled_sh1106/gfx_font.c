@@ -132,7 +132,7 @@ const gfx_glyph_t font5x5_glyphs[] = {
 
 const gfx_font_t font5x5 = { (uint8_t *)font5x5_bitmaps,
                              (gfx_glyph_t *)font5x5_glyphs,
-                             0x20, 0x7E, 7 };
+                             0x20, 0x7E, 7, NULL, 0 };
 
 /***************************************************************************//**
  *  font 4x5.
@@ -255,7 +255,7 @@ const gfx_glyph_t font4x5_glyphs[] = {
 
 const gfx_font_t font4x5 = { (uint8_t *)font4x5_bitmaps,
                              (gfx_glyph_t *)font4x5_glyphs,
-                             0x20, 0x7E, 7 };
+                             0x20, 0x7E, 7, NULL, 0 };
 
 /***************************************************************************//**
  *  font 3x3.
@@ -375,7 +375,7 @@ const gfx_glyph_t font3x3_glyphs[] = {
 
 const gfx_font_t font3x3 = { (uint8_t *)font3x3_bitmaps,
                              (gfx_glyph_t *)font3x3_glyphs,
-                             0x20, 0x7E, 4 };
+                             0x20, 0x7E, 4, NULL, 0 };
 
 /***************************************************************************//**
  *  font 13x13.
@@ -579,7 +579,7 @@ const gfx_glyph_t font13x13_glyphs[] = {
 
 const gfx_font_t font13x13 = { (uint8_t *)font13x13_bitmaps,
                                (gfx_glyph_t *)font13x13_glyphs,
-                               0x20, 0x7E, 22 };
+                               0x20, 0x7E, 22, NULL, 0 };
 
 /***************************************************************************//**
  *  font diaglog input_4x6 plain.
@@ -706,7 +706,7 @@ const gfx_glyph_t font_diaglog_input_4x6_glyphs[] = {
 const gfx_font_t font_diaglog_input_4x6 = {
   (uint8_t  *)font_diaglog_input_4x6_bitmaps,
   (gfx_glyph_t *)font_diaglog_input_4x6_glyphs,
-  0x20, 0x7E, 10
+  0x20, 0x7E, 10, NULL, 0
 };
 
 /***************************************************************************//**
@@ -833,8 +833,23 @@ const gfx_glyph_t font_diaglog_input_4x6_italic_glyphs[] = {
   { 270, 1, 8, 6, 2, -7 },  // '|'
   { 271, 6, 7, 6, -2, -7 }  // '}'
 };
+/* narrows the gaps around '.' and ':' in numeric readouts */
+const gfx_kern_pair_t font_diaglog_input_4x6_italic_kern[] = {
+  { '.', '0', -2 }, { '.', '1', -2 }, { '.', '2', -2 }, { '.', '3', -2 },
+  { '.', '4', -2 }, { '.', '5', -2 }, { '.', '6', -2 }, { '.', '7', -2 },
+  { '.', '8', -2 }, { '.', '9', -2 }, { '0', '.', -1 }, { '0', ':', -1 },
+  { '1', '.', -1 }, { '1', ':', -1 }, { '2', '.', -1 }, { '2', ':', -1 },
+  { '3', '.', -1 }, { '3', ':', -1 }, { '4', '.', -1 }, { '4', ':', -1 },
+  { '5', '.', -1 }, { '5', ':', -1 }, { '6', '.', -1 }, { '6', ':', -1 },
+  { '7', '.', -1 }, { '7', ':', -1 }, { '8', '.', -1 }, { '8', ':', -1 },
+  { '9', '.', -1 }, { '9', ':', -1 }, { ':', '0', -1 }, { ':', '1', -1 },
+  { ':', '2', -1 }, { ':', '3', -1 }, { ':', '4', -1 }, { ':', '5', -1 },
+  { ':', '6', -1 }, { ':', '7', -1 }, { ':', '8', -1 }, { ':', '9', -1 }
+};
 const  gfx_font_t font_diaglog_input_4x6_italic = {
   (uint8_t  *)font_diaglog_input_4x6_italic_bitmaps,
   (gfx_glyph_t *)font_diaglog_input_4x6_italic_glyphs,
-  0x20, 0x7E, 10
+  0x20, 0x7E, 10,
+  font_diaglog_input_4x6_italic_kern,
+  sizeof(font_diaglog_input_4x6_italic_kern) / sizeof(gfx_kern_pair_t)
 };
@@ -0,0 +1,297 @@
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include "gfx_font_pack.h"
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// -----------------------------------------------------------------------------
+//                               Macros
+// -----------------------------------------------------------------------------
+
+/* glyph records of the pack are used in place as gfx_glyph_t */
+_Static_assert(sizeof(gfx_glyph_t) == 8, "unexpected gfx_glyph_t layout");
+_Static_assert(sizeof(gfx_font_pack_header_t) == 24, "bad pack header size");
+_Static_assert(sizeof(gfx_font_pack_entry_t) == 36, "bad pack entry size");
+
+// -----------------------------------------------------------------------------
+//                            Local functions declaration
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ * @brief
+ *  Compute the CRC-32 (IEEE 802.3) of a memory block.
+ *
+ * @param[in] data
+ *  The data to compute CRC on.
+ * @param[in] len
+ *  The length of the data.
+ *
+ * @return
+ *  The CRC-32 value.
+ ******************************************************************************/
+static uint32_t gfx_font_pack_crc32(const uint8_t *data, size_t len);
+
+/***************************************************************************//**
+ * @brief
+ *  Check that the range [offset, offset + len) lies inside the image.
+ *
+ * @return
+ *  true if the range is inside the image.
+ ******************************************************************************/
+static bool gfx_font_pack_in_range(uint32_t total, uint32_t offset,
+                                   uint32_t len);
+
+/***************************************************************************//**
+ * @brief
+ *  Validate one font entry of the pack and bind it to a gfx_font_t.
+ *
+ * @return
+ *  ESP_OK               if OK.
+ *  ESP_ERR_INVALID_SIZE if the entry is malformed.
+ ******************************************************************************/
+static esp_err_t gfx_font_pack_bind(const uint8_t *base, uint32_t total,
+                                    const gfx_font_pack_entry_t *entry,
+                                    gfx_font_t *font);
+
+// -----------------------------------------------------------------------------
+//                               Public functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Validate a font pack image and bind its fonts.
+ ******************************************************************************/
+esp_err_t gfx_font_pack_load(gfx_font_pack_t *pack,
+                             const void *data, size_t size)
+{
+  const uint8_t *base = (const uint8_t *)data;
+  const gfx_font_pack_header_t *header = (const gfx_font_pack_header_t *)data;
+  esp_err_t status;
+
+  if ((pack == NULL) || (data == NULL) || ((uintptr_t)data & 3)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (size < sizeof(gfx_font_pack_header_t)) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  if (memcmp(header->magic, GFX_FONT_PACK_MAGIC, 4) != 0
+      || (header->version != GFX_FONT_PACK_VERSION)) {
+    return ESP_ERR_INVALID_VERSION;
+  }
+  if ((header->header_size != sizeof(gfx_font_pack_header_t))
+      || (header->total_size > size)
+      || (header->font_count > GFX_FONT_PACK_MAX_FONTS)
+      || !gfx_font_pack_in_range(header->total_size,
+                                 header->header_size,
+                                 header->font_count
+                                 * sizeof(gfx_font_pack_entry_t))) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  if (gfx_font_pack_crc32(base + header->header_size,
+                          header->total_size - header->header_size)
+      != header->crc32) {
+    return ESP_ERR_INVALID_CRC;
+  }
+
+  pack->entry = (const gfx_font_pack_entry_t *)(base + header->header_size);
+  for (uint16_t i = 0; i < header->font_count; i++) {
+    status = gfx_font_pack_bind(base, header->total_size,
+                                &pack->entry[i], &pack->fonts[i]);
+    if (status != ESP_OK) {
+      return status;
+    }
+  }
+  pack->base = base;
+  pack->size = header->total_size;
+  pack->font_count = header->font_count;
+  return ESP_OK;
+}
+
+#if defined(__linux__)
+/***************************************************************************//**
+ *  Map a font pack file and load it.
+ ******************************************************************************/
+esp_err_t gfx_font_pack_open_file(gfx_font_pack_t *pack, const char *path)
+{
+  struct stat st;
+  void *map;
+  esp_err_t status;
+  int fd;
+
+  memset(pack, 0, sizeof(*pack));
+  fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return ESP_ERR_NOT_FOUND;
+  }
+  if ((fstat(fd, &st) != 0) || (st.st_size <= 0)) {
+    close(fd);
+    return ESP_ERR_INVALID_SIZE;
+  }
+  map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    return ESP_FAIL;
+  }
+
+  status = gfx_font_pack_load(pack, map, (size_t)st.st_size);
+  if (status != ESP_OK) {
+    munmap(map, (size_t)st.st_size);
+    return status;
+  }
+  pack->map_size = (size_t)st.st_size;
+  return ESP_OK;
+}
+#else
+/***************************************************************************//**
+ *  Map a font pack stored in a data partition and load it.
+ ******************************************************************************/
+esp_err_t gfx_font_pack_open_partition(gfx_font_pack_t *pack,
+                                       const char *label)
+{
+  const esp_partition_t *partition;
+  gfx_font_pack_header_t header;
+  const void *map;
+  esp_err_t status;
+
+  memset(pack, 0, sizeof(*pack));
+  partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                       ESP_PARTITION_SUBTYPE_ANY,
+                                       label);
+  if (partition == NULL) {
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  // Read the header first so only the used part of the partition is mapped
+  status = esp_partition_read(partition, 0, &header, sizeof(header));
+  if (status != ESP_OK) {
+    return status;
+  }
+  if ((header.total_size < sizeof(header))
+      || (header.total_size > partition->size)) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  status = esp_partition_mmap(partition, 0, header.total_size,
+                              SPI_FLASH_MMAP_DATA, &map, &pack->map_handle);
+  if (status != ESP_OK) {
+    return status;
+  }
+  status = gfx_font_pack_load(pack, map, header.total_size);
+  if (status != ESP_OK) {
+    spi_flash_munmap(pack->map_handle);
+    return status;
+  }
+  pack->mapped = true;
+  return ESP_OK;
+}
+#endif
+
+/***************************************************************************//**
+ *  Release the mapping of a font pack.
+ ******************************************************************************/
+void gfx_font_pack_close(gfx_font_pack_t *pack)
+{
+#if defined(__linux__)
+  if (pack->map_size) {
+    munmap((void *)pack->base, pack->map_size);
+  }
+#else
+  if (pack->mapped) {
+    spi_flash_munmap(pack->map_handle);
+  }
+#endif
+  memset(pack, 0, sizeof(*pack));
+}
+
+/***************************************************************************//**
+ *  Find a font of the pack by name.
+ ******************************************************************************/
+const gfx_font_t *gfx_font_pack_find(const gfx_font_pack_t *pack,
+                                     const char *name)
+{
+  for (uint16_t i = 0; i < pack->font_count; i++) {
+    if (strncmp(pack->entry[i].name, name, GFX_FONT_PACK_NAME_LEN) == 0) {
+      return &pack->fonts[i];
+    }
+  }
+  return NULL;
+}
+
+// -----------------------------------------------------------------------------
+//                         Local functions definitions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Compute the CRC-32 of a memory block.
+ ******************************************************************************/
+static uint32_t gfx_font_pack_crc32(const uint8_t *data, size_t len)
+{
+  uint32_t crc = 0xFFFFFFFF;
+
+  while (len--) {
+    crc ^= *data++;
+    for (uint8_t i = 0; i < 8; i++) {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+/***************************************************************************//**
+ *  Check that a range lies inside the image.
+ ******************************************************************************/
+static bool gfx_font_pack_in_range(uint32_t total, uint32_t offset,
+                                   uint32_t len)
+{
+  return (offset <= total) && (len <= total - offset);
+}
+
+/***************************************************************************//**
+ *  Validate one font entry and bind it to a gfx_font_t.
+ ******************************************************************************/
+static esp_err_t gfx_font_pack_bind(const uint8_t *base, uint32_t total,
+                                    const gfx_font_pack_entry_t *entry,
+                                    gfx_font_t *font)
+{
+  const gfx_glyph_t *glyph;
+  uint32_t count;
+
+  if ((entry->first > entry->last)
+      || (entry->glyph_offset & 3)
+      || (entry->bitmap_size > 0xFFFF)) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  count = entry->last - entry->first + 1;
+  if (!gfx_font_pack_in_range(total, entry->glyph_offset,
+                              count * sizeof(gfx_glyph_t))
+      || !gfx_font_pack_in_range(total, entry->bitmap_offset,
+                                 entry->bitmap_size)) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  // Every glyph bitmap must stay inside the font bitmap area
+  glyph = (const gfx_glyph_t *)(base + entry->glyph_offset);
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t bytes = ((uint32_t)glyph[i].width * glyph[i].height + 7) / 8;
+    if (!gfx_font_pack_in_range(entry->bitmap_size,
+                                glyph[i].bitmap_offset, bytes)) {
+      return ESP_ERR_INVALID_SIZE;
+    }
+  }
+
+  font->bitmap = (uint8_t *)(base + entry->bitmap_offset);
+  font->glyph = (gfx_glyph_t *)glyph;
+  font->first = entry->first;
+  font->last = entry->last;
+  font->y_advance = entry->y_advance;
+  font->kern = NULL;
+  font->kern_count = 0;
+  return ESP_OK;
+}
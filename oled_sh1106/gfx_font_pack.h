@@ -0,0 +1,161 @@
+#ifndef _GFX_FONT_PACK_H_
+#define _GFX_FONT_PACK_H_
+
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "sh1106.h"
+#if !defined(__linux__)
+#include "esp_partition.h"
+#endif
+
+// -----------------------------------------------------------------------------
+//                               Macros and Typedefs
+// -----------------------------------------------------------------------------
+
+/* font pack identification */
+#define GFX_FONT_PACK_MAGIC                     "GFXP"
+#define GFX_FONT_PACK_VERSION                   1
+
+/* limits of a font pack */
+#define GFX_FONT_PACK_MAX_FONTS                 8
+#define GFX_FONT_PACK_NAME_LEN                  16
+
+/*
+ * Binary layout of a font pack (all fields little-endian):
+ *
+ *   gfx_font_pack_header_t                 at offset 0
+ *   gfx_font_pack_entry_t[font_count]      at offset header_size
+ *   gfx_glyph_t[] and bitmaps              at the offsets given by each entry
+ *
+ * Glyph records are stored with the exact in-memory layout of gfx_glyph_t so
+ * the glyph table and the bitmaps are used in place from the mapped image.
+ */
+
+/// Font pack header
+typedef struct {
+  char magic[4];          ///< GFX_FONT_PACK_MAGIC
+  uint16_t version;       ///< GFX_FONT_PACK_VERSION
+  uint16_t header_size;   ///< sizeof(gfx_font_pack_header_t)
+  uint32_t total_size;    ///< Size of the whole pack in bytes
+  uint32_t crc32;         ///< CRC-32 of bytes [header_size, total_size)
+  uint16_t font_count;    ///< Number of font entries
+  uint16_t reserved[3];   ///< Must be zero
+} gfx_font_pack_header_t;
+
+/// Font pack entry, one per font
+typedef struct {
+  char name[GFX_FONT_PACK_NAME_LEN]; ///< Font name, NUL padded
+  uint32_t glyph_offset;  ///< Offset of the glyph array from the pack start
+  uint32_t bitmap_offset; ///< Offset of the bitmaps from the pack start
+  uint32_t bitmap_size;   ///< Size of the bitmaps in bytes
+  uint16_t first;         ///< ASCII extents (first char)
+  uint16_t last;          ///< ASCII extents (last char)
+  uint8_t y_advance;      ///< Newline distance (y axis)
+  uint8_t reserved[3];    ///< Must be zero
+} gfx_font_pack_entry_t;
+
+/// Font pack loaded from a mapped image
+typedef struct {
+  const uint8_t *base;    ///< Start of the mapped image
+  size_t size;            ///< Size of the mapped image
+  uint16_t font_count;    ///< Number of fonts in the pack
+  gfx_font_t fonts[GFX_FONT_PACK_MAX_FONTS]; ///< Fonts pointing into the image
+  const gfx_font_pack_entry_t *entry;        ///< Entry table in the image
+#if defined(__linux__)
+  size_t map_size;        ///< Size passed to mmap(), 0 if not mapped
+#else
+  spi_flash_mmap_handle_t map_handle; ///< Partition mapping handle
+  bool mapped;            ///< True if map_handle is valid
+#endif
+} gfx_font_pack_t;
+
+// -----------------------------------------------------------------------------
+//                               Public functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ * @brief
+ *  Validate a font pack image already present in memory and bind its fonts.
+ *  The image is used in place, nothing is copied.
+ *
+ * @param[out] pack
+ *  The font pack to initialize.
+ * @param[in] data
+ *  The start of the font pack image. Must be 4-byte aligned.
+ * @param[in] size
+ *  The size of the memory holding the image.
+ *
+ * @return
+ *  ESP_OK                  if OK.
+ *  ESP_ERR_INVALID_VERSION if the magic or version does not match.
+ *  ESP_ERR_INVALID_SIZE    if a table or bitmap lies outside the image.
+ *  ESP_ERR_INVALID_CRC     if the payload CRC does not match.
+ ******************************************************************************/
+esp_err_t gfx_font_pack_load(gfx_font_pack_t *pack,
+                             const void *data, size_t size);
+
+#if defined(__linux__)
+/***************************************************************************//**
+ * @brief
+ *  Map a font pack file read-only and load it.
+ *
+ * @param[out] pack
+ *  The font pack to initialize.
+ * @param[in] path
+ *  The path of the font pack file.
+ *
+ * @return
+ *  ESP_OK            if OK.
+ *  Other return code if Failed.
+ ******************************************************************************/
+esp_err_t gfx_font_pack_open_file(gfx_font_pack_t *pack, const char *path);
+#else
+/***************************************************************************//**
+ * @brief
+ *  Map a font pack stored in a data partition and load it.
+ *
+ * @param[out] pack
+ *  The font pack to initialize.
+ * @param[in] label
+ *  The label of the data partition holding the font pack.
+ *
+ * @return
+ *  ESP_OK            if OK.
+ *  ESP_ERR_NOT_FOUND if the partition does not exist.
+ *  Other return code if Failed.
+ ******************************************************************************/
+esp_err_t gfx_font_pack_open_partition(gfx_font_pack_t *pack,
+                                       const char *label);
+#endif
+
+/***************************************************************************//**
+ * @brief
+ *  Release the mapping of a font pack. Fonts of the pack must not be used
+ *  after this call.
+ *
+ * @param[in] pack
+ *  The font pack to close.
+ ******************************************************************************/
+void gfx_font_pack_close(gfx_font_pack_t *pack);
+
+/***************************************************************************//**
+ * @brief
+ *  Find a font of the pack by name.
+ *
+ * @param[in] pack
+ *  The loaded font pack.
+ * @param[in] name
+ *  The name of the font.
+ *
+ * @return
+ *  The font, or NULL if the pack holds no font with this name.
+ ******************************************************************************/
+const gfx_font_t *gfx_font_pack_find(const gfx_font_pack_t *pack,
+                                     const char *name);
+
+#endif /* _GFX_FONT_PACK_H_ */
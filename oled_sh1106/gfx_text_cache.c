@@ -0,0 +1,272 @@
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gfx_text_cache.h"
+
+// -----------------------------------------------------------------------------
+//                               Macros and Typedefs
+// -----------------------------------------------------------------------------
+
+/// One rendered string
+typedef struct {
+  const gfx_font_t *font; ///< Font used to render, NULL for the classic font
+  uint8_t size_x;         ///< Magnification in x axis
+  uint8_t size_y;         ///< Magnification in y axis
+  bool cp437;             ///< CP437 charset, moves glyphs 176 and up
+  uint32_t hash;          ///< Hash of the string
+  char str[GFX_TEXT_CACHE_MAX_STR_LEN + 1]; ///< The string
+  int16_t dx;             ///< Bounding box offset from the cursor in x axis
+  int16_t dy;             ///< Bounding box offset from the cursor in y axis
+  int16_t w;              ///< Width of the strip
+  int16_t h;              ///< Height of the strip
+  int16_t advance;        ///< Cursor advance in x axis
+  uint8_t *strip;         ///< Rendered text in page format, NULL if unused
+  size_t bytes;           ///< Size of the strip
+  uint32_t last_used;     ///< Use stamp for LRU eviction
+} gfx_text_cache_entry_t;
+
+// -----------------------------------------------------------------------------
+//                               Local variables
+// -----------------------------------------------------------------------------
+
+static gfx_text_cache_entry_t cache_entry[GFX_TEXT_CACHE_MAX_ENTRIES];
+static gfx_text_cache_stats_t cache_stats;
+static uint32_t cache_clock;
+
+// -----------------------------------------------------------------------------
+//                            Local functions declaration
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ * @brief
+ *  FNV-1a hash of a string.
+ *
+ * @param[in] str
+ *  The string to hash.
+ * @param[out] len
+ *  The length of the string, scanning stops after
+ *  GFX_TEXT_CACHE_MAX_STR_LEN + 1 characters.
+ *
+ * @return
+ *  The hash value.
+ ******************************************************************************/
+static uint32_t gfx_text_cache_hash(const char *str, size_t *len);
+
+/***************************************************************************//**
+ * @brief
+ *  Free one entry of the cache.
+ ******************************************************************************/
+static void gfx_text_cache_free(gfx_text_cache_entry_t *entry);
+
+/***************************************************************************//**
+ * @brief
+ *  Render a string into a new cache entry, evicting old entries as needed.
+ *
+ * @return
+ *  The new entry, or NULL if the string cannot be cached.
+ ******************************************************************************/
+static gfx_text_cache_entry_t *gfx_text_cache_insert(
+  display_context_t *context, const char *str, uint32_t hash);
+
+// -----------------------------------------------------------------------------
+//                               Public functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Enable the text cache.
+ ******************************************************************************/
+esp_err_t gfx_text_cache_init(size_t budget_bytes)
+{
+  gfx_text_cache_clear();
+  memset(&cache_stats, 0, sizeof(cache_stats));
+  cache_stats.budget_bytes = budget_bytes;
+  return ESP_OK;
+}
+
+/***************************************************************************//**
+ *  Drop every cached string.
+ ******************************************************************************/
+void gfx_text_cache_clear(void)
+{
+  for (int i = 0; i < GFX_TEXT_CACHE_MAX_ENTRIES; i++) {
+    gfx_text_cache_free(&cache_entry[i]);
+  }
+}
+
+/***************************************************************************//**
+ *  Draw a string through the cache.
+ ******************************************************************************/
+esp_err_t gfx_text_cache_write_string(display_context_t *context,
+                                      const char *str,
+                                      int16_t x0, int16_t y0)
+{
+  gfx_text_cache_entry_t *entry = NULL;
+  esp_err_t status = ESP_OK;
+  uint32_t hash;
+  size_t len;
+
+  hash = gfx_text_cache_hash(str, &len);
+  if ((len > GFX_TEXT_CACHE_MAX_STR_LEN) || context->wrap
+      || (strchr(str, '\n') != NULL) || (cache_stats.budget_bytes == 0)) {
+    cache_stats.bypasses++;
+    return sh1106_write_string(context, str, x0, y0);
+  }
+
+  for (int i = 0; i < GFX_TEXT_CACHE_MAX_ENTRIES; i++) {
+    gfx_text_cache_entry_t *e = &cache_entry[i];
+    if (e->strip && (e->hash == hash) && (e->font == context->font)
+        && (e->size_x == context->textsize_x)
+        && (e->size_y == context->textsize_y)
+        && (e->cp437 == context->cp437)
+        && (strcmp(e->str, str) == 0)) {
+      entry = e;
+      break;
+    }
+  }
+  if (entry) {
+    cache_stats.hits++;
+  } else {
+    entry = gfx_text_cache_insert(context, str, hash);
+    if (entry == NULL) {
+      cache_stats.bypasses++;
+      return sh1106_write_string(context, str, x0, y0);
+    }
+    cache_stats.misses++;
+  }
+  entry->last_used = ++cache_clock;
+
+  // The classic font paints its background when it differs from the text
+  if (!context->font && (context->bg_color != context->text_color)) {
+    status |= sh1106_draw_fill_rectangle(context,
+                                         x0 + entry->dx, y0 + entry->dy,
+                                         entry->w, entry->h,
+                                         context->bg_color);
+  }
+  status |= sh1106_draw_page_bitmap(context,
+                                    x0 + entry->dx, y0 + entry->dy,
+                                    entry->strip, entry->w, entry->h,
+                                    context->text_color);
+  context->cursor_x = x0 + entry->advance;
+  context->cursor_y = y0;
+  return status;
+}
+
+/***************************************************************************//**
+ *  Get the cache counters.
+ ******************************************************************************/
+void gfx_text_cache_get_stats(gfx_text_cache_stats_t *stats)
+{
+  *stats = cache_stats;
+}
+
+/***************************************************************************//**
+ *  Reset the cache counters.
+ ******************************************************************************/
+void gfx_text_cache_reset_stats(void)
+{
+  cache_stats.hits = cache_stats.misses = 0;
+  cache_stats.evictions = cache_stats.bypasses = 0;
+}
+
+// -----------------------------------------------------------------------------
+//                         Local functions definitions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  FNV-1a hash of a string.
+ ******************************************************************************/
+static uint32_t gfx_text_cache_hash(const char *str, size_t *len)
+{
+  uint32_t hash = 2166136261u;
+  size_t n = 0;
+
+  while (str[n] && (n <= GFX_TEXT_CACHE_MAX_STR_LEN)) {
+    hash = (hash ^ (uint8_t)str[n++]) * 16777619u;
+  }
+  *len = n;
+  return hash;
+}
+
+/***************************************************************************//**
+ *  Free one entry of the cache.
+ ******************************************************************************/
+static void gfx_text_cache_free(gfx_text_cache_entry_t *entry)
+{
+  if (entry->strip) {
+    free(entry->strip);
+    cache_stats.used_bytes -= entry->bytes;
+  }
+  memset(entry, 0, sizeof(*entry));
+}
+
+/***************************************************************************//**
+ *  Render a string into a new cache entry.
+ ******************************************************************************/
+static gfx_text_cache_entry_t *gfx_text_cache_insert(
+  display_context_t *context, const char *str, uint32_t hash)
+{
+  gfx_text_cache_entry_t *entry;
+  display_context_t strip_context;
+  int16_t x1, y1;
+  uint16_t w, h;
+  size_t bytes;
+
+  sh1106_get_text_bounds(context, str, 0, 0, &x1, &y1, &w, &h);
+  bytes = (size_t)w * ((h + 7) / 8);
+  if ((bytes == 0) || (bytes > cache_stats.budget_bytes)) {
+    return NULL;
+  }
+
+  // Evict least recently used entries until a slot and the bytes are free
+  for (;;) {
+    gfx_text_cache_entry_t *lru = NULL;
+    entry = NULL;
+    for (int i = 0; i < GFX_TEXT_CACHE_MAX_ENTRIES; i++) {
+      if (!cache_entry[i].strip) {
+        entry = &cache_entry[i];
+      } else if (!lru || (cache_entry[i].last_used < lru->last_used)) {
+        lru = &cache_entry[i];
+      }
+    }
+    if (entry && (cache_stats.used_bytes + bytes
+                  <= cache_stats.budget_bytes)) {
+      break;
+    }
+    gfx_text_cache_free(lru);
+    cache_stats.evictions++;
+  }
+
+  entry->strip = calloc(1, bytes);
+  if (entry->strip == NULL) {
+    return NULL;
+  }
+  entry->bytes = bytes;
+  cache_stats.used_bytes += bytes;
+
+  // Render the ink only, with the bounding box at the origin of the strip
+  strip_context = *context;
+  strip_context.width = w;
+  strip_context.height = h;
+  strip_context.rotation = origin;
+  strip_context.text_color = strip_context.bg_color = WHITE;
+  sh1106_set_render_target(entry->strip, w);
+  sh1106_write_string(&strip_context, str, -x1, -y1);
+  sh1106_set_render_target(NULL, 0);
+
+  entry->font = context->font;
+  entry->size_x = context->textsize_x;
+  entry->size_y = context->textsize_y;
+  entry->cp437 = context->cp437;
+  entry->hash = hash;
+  strcpy(entry->str, str);
+  entry->dx = x1;
+  entry->dy = y1;
+  entry->w = w;
+  entry->h = h;
+  entry->advance = strip_context.cursor_x + x1;
+  return entry;
+}
@@ -0,0 +1,101 @@
+#ifndef _GFX_TEXT_CACHE_H_
+#define _GFX_TEXT_CACHE_H_
+
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "sh1106.h"
+
+// -----------------------------------------------------------------------------
+//                               Macros and Typedefs
+// -----------------------------------------------------------------------------
+
+/* number of strings the cache can hold */
+#ifndef GFX_TEXT_CACHE_MAX_ENTRIES
+#define GFX_TEXT_CACHE_MAX_ENTRIES              16
+#endif
+
+/* longest string that is cached, longer strings are drawn directly */
+#ifndef GFX_TEXT_CACHE_MAX_STR_LEN
+#define GFX_TEXT_CACHE_MAX_STR_LEN              24
+#endif
+
+/// Text cache counters
+typedef struct {
+  uint32_t hits;          ///< Strings blitted from the cache
+  uint32_t misses;        ///< Strings rendered and inserted
+  uint32_t evictions;     ///< Entries dropped to make room
+  uint32_t bypasses;      ///< Strings that could not be cached
+  size_t used_bytes;      ///< Bytes of rendered strips in the cache
+  size_t budget_bytes;    ///< Maximum bytes of rendered strips
+} gfx_text_cache_stats_t;
+
+// -----------------------------------------------------------------------------
+//                               Public functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ * @brief
+ *  Enable the text cache.
+ *
+ * @param[in] budget_bytes
+ *  Maximum RAM used for rendered strips. Least recently used strings are
+ *  evicted when a new one does not fit.
+ *
+ * @return
+ *  ESP_OK            if OK.
+ *  Other return code if Failed.
+ ******************************************************************************/
+esp_err_t gfx_text_cache_init(size_t budget_bytes);
+
+/***************************************************************************//**
+ * @brief
+ *  Drop every cached string and free its memory. Must be called before a
+ *  font referenced by the cache is released (e.g. a font pack is closed).
+ ******************************************************************************/
+void gfx_text_cache_clear(void);
+
+/***************************************************************************//**
+ * @brief
+ *  Draw a string like sh1106_write_string(), blitting it from the cache when
+ *  the same string was already rendered with the same font and text size.
+ *  Strings containing a newline, longer than GFX_TEXT_CACHE_MAX_STR_LEN or
+ *  drawn with wrap enabled are drawn directly.
+ *
+ * @param[in] context
+ *  The pointer to current display context.
+ * @param[in] str
+ *  The string sent to SH1106.
+ * @param[in] x0
+ *  Position in x axis.
+ * @param[in] y0
+ *  Position in y axis.
+ *
+ * @return
+ *  ESP_OK            if OK.
+ *  Other return code if Failed.
+ ******************************************************************************/
+esp_err_t gfx_text_cache_write_string(display_context_t *context,
+                                      const char *str,
+                                      int16_t x0, int16_t y0);
+
+/***************************************************************************//**
+ * @brief
+ *  Get the cache counters.
+ *
+ * @param[out] stats
+ *  The cache counters.
+ ******************************************************************************/
+void gfx_text_cache_get_stats(gfx_text_cache_stats_t *stats);
+
+/***************************************************************************//**
+ * @brief
+ *  Reset the hit, miss, eviction and bypass counters.
+ ******************************************************************************/
+void gfx_text_cache_reset_stats(void);
+
+#endif /* _GFX_TEXT_CACHE_H_ */
@@ -27,6 +27,8 @@
 
 static i2c_port_t sh1106_i2c_port;
 static uint8_t frame_buffer[SCREEN_WIDTH * (SCREEN_HEIGHT / 8)];
+static uint8_t *render_buffer = frame_buffer;
+static int16_t render_width = SCREEN_WIDTH;
 
 // -----------------------------------------------------------------------------
 //                            Local functions declaration
@@ -113,6 +115,33 @@ static esp_err_t sh1106_draw_circle_helper(display_context_t *context,
                                            uint8_t cornername,
                                            SH1106_PIXEL_COLOR color);
 
+/***************************************************************************//**
+ * @brief
+ *  Extend the bounding box of a text with one character and advance the
+ *  cursor, the same way sh1106_write_char() does.
+ *
+ * @param[in] context
+ *  The pointer to current display context.
+ * @param[in] c
+ *  The character to measure.
+ * @param[in,out] x
+ *  The cursor position in x axis.
+ * @param[in,out] y
+ *  The cursor position in y axis.
+ * @param[in,out] minx
+ *  The minimum x of the bounding box.
+ * @param[in,out] miny
+ *  The minimum y of the bounding box.
+ * @param[in,out] maxx
+ *  The maximum x of the bounding box.
+ * @param[in,out] maxy
+ *  The maximum y of the bounding box.
+ ******************************************************************************/
+static void sh1106_char_bounds(display_context_t *context, unsigned char c,
+                               int16_t *x, int16_t *y,
+                               int16_t *minx, int16_t *miny,
+                               int16_t *maxx, int16_t *maxy);
+
 // -----------------------------------------------------------------------------
 //                               Public functions
 // -----------------------------------------------------------------------------
@@ -182,7 +211,8 @@ esp_err_t sh1106_draw_pixel(display_context_t *context,
                             int16_t x, int16_t y,
                             SH1106_PIXEL_COLOR color)
 {
-  if ((x < context->width) && (y < context->height) && (x > 0) && (y > 0)) {
+  if ((x < context->width) && (y < context->height)
+      && (x >= 0) && (y >= 0)) {
     int16_t t;
     switch (context->rotation) {
       case 1:
@@ -201,9 +231,9 @@ esp_err_t sh1106_draw_pixel(display_context_t *context,
         break;
     }
     if (color == WHITE) {
-      frame_buffer[128 * (y / 8) + x] |= (1 << (y % 8));
+      render_buffer[render_width * (y / 8) + x] |= (1 << (y % 8));
     } else {
-      frame_buffer[128 * (y / 8) + x] &= ~(1 << (y % 8));
+      render_buffer[render_width * (y / 8) + x] &= ~(1 << (y % 8));
     }
   }
   return ESP_OK;
@@ -853,6 +883,35 @@ esp_err_t sh1106_write_char(display_context_t *context, char c)
   return status;
 }
 
+/***************************************************************************//**
+ *  Get the kerning adjustment of a pair of characters.
+ ******************************************************************************/
+int8_t sh1106_get_kerning(const gfx_font_t *font,
+                          unsigned char left, unsigned char right)
+{
+  uint16_t key = ((uint16_t)left << 8) | right;
+  int32_t lo = 0;
+  int32_t hi;
+
+  if ((font == NULL) || (font->kern == NULL)) {
+    return 0;
+  }
+  hi = (int32_t)font->kern_count - 1;
+  while (lo <= hi) {
+    int32_t mid = (lo + hi) / 2;
+    uint16_t pair = ((uint16_t)font->kern[mid].left << 8)
+                    | font->kern[mid].right;
+    if (pair == key) {
+      return font->kern[mid].adjust;
+    } else if (pair < key) {
+      lo = mid + 1;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  return 0;
+}
+
 /***************************************************************************//**
  *  Draw a string on SH1106 at the current position of the cursor.
  ******************************************************************************/
@@ -860,12 +919,18 @@ esp_err_t sh1106_write_string(display_context_t *context, const char *str,
                               int16_t x0, int16_t y0)
 {
   esp_err_t status;
+  unsigned char prev = 0;
 
   context->cursor_x = x0;
   context->cursor_y = y0;
 
   /* Loops through the string and prints char for char */
   while (*str) {
+    if (prev) {
+      context->cursor_x += sh1106_get_kerning(context->font, prev, *str)
+                           * context->textsize_x;
+    }
+    prev = (*str == '\n') ? 0 : (unsigned char)*str;
     status = sh1106_write_char(context, *str);
     if (status != ESP_OK) {
       // Char could not be written
@@ -877,6 +942,40 @@ esp_err_t sh1106_write_string(display_context_t *context, const char *str,
   return ESP_OK;
 }
 
+/***************************************************************************//**
+ *  Compute the bounding box of a string.
+ ******************************************************************************/
+void sh1106_get_text_bounds(display_context_t *context, const char *str,
+                            int16_t x, int16_t y,
+                            int16_t *x1, int16_t *y1,
+                            uint16_t *w, uint16_t *h)
+{
+  int16_t minx = 0x7FFF, miny = 0x7FFF, maxx = -1, maxy = -1;
+  unsigned char prev = 0;
+
+  *x1 = x;
+  *y1 = y;
+  *w = *h = 0;
+
+  while (*str) {
+    if (prev) {
+      x += sh1106_get_kerning(context->font, prev, *str)
+           * context->textsize_x;
+    }
+    prev = (*str == '\n') ? 0 : (unsigned char)*str;
+    sh1106_char_bounds(context, (unsigned char)*str++,
+                       &x, &y, &minx, &miny, &maxx, &maxy);
+  }
+  if (maxx >= minx) {
+    *x1 = minx;
+    *w = maxx - minx + 1;
+  }
+  if (maxy >= miny) {
+    *y1 = miny;
+    *h = maxy - miny + 1;
+  }
+}
+
 /***************************************************************************//**
  *  Draw a RAM-resident 1-bit image at the specified (x,y) position.
  ******************************************************************************/
@@ -906,6 +1005,75 @@ esp_err_t sh1106_draw_bitmap(display_context_t *context,
   return status;
 }
 
+/***************************************************************************//**
+ *  Draw a page-format 1-bit image at the specified (x,y) position.
+ ******************************************************************************/
+esp_err_t sh1106_draw_page_bitmap(display_context_t *context,
+                                  int16_t x, int16_t y, const uint8_t *bitmap,
+                                  int16_t w, int16_t h,
+                                  SH1106_PIXEL_COLOR color)
+{
+  esp_err_t status = ESP_OK;
+  int16_t pages = (h + 7) / 8;
+
+  if (context->rotation != origin) {
+    // Rotated output is not page aligned, go pixel by pixel
+    for (int16_t i = 0; i < w; i++) {
+      for (int16_t j = 0; j < h; j++) {
+        if (bitmap[(j / 8) * w + i] & (1 << (j % 8))) {
+          status |= sh1106_draw_pixel(context, x + i, y + j, color);
+        }
+      }
+    }
+    return status;
+  }
+
+  for (int16_t p = 0; p < pages; p++) {
+    int16_t row = y + p * 8;
+    int16_t shift = ((row % 8) + 8) % 8;
+    int16_t page = (row - shift) / 8;
+    uint8_t mask = 0xFF;
+
+    if ((p == pages - 1) && (h % 8)) {
+      mask = (1 << (h % 8)) - 1;     // Rows below the image in last page
+    }
+    for (int16_t i = 0; i < w; i++) {
+      int16_t col = x + i;
+      uint16_t bits = (uint16_t)(bitmap[p * w + i] & mask) << shift;
+
+      if (!bits || (col < 0) || (col >= context->width)) {
+        continue;
+      }
+      for (int16_t k = 0; k < 2; k++, bits >>= 8) {
+        int16_t target = page + k;
+        if ((target < 0) || (target >= context->height / 8)) {
+          continue;
+        }
+        if (color == WHITE) {
+          render_buffer[render_width * target + col] |= (uint8_t)bits;
+        } else {
+          render_buffer[render_width * target + col] &= ~(uint8_t)bits;
+        }
+      }
+    }
+  }
+  return status;
+}
+
+/***************************************************************************//**
+ *  Redirect drawing to a page-format off-screen buffer.
+ ******************************************************************************/
+void sh1106_set_render_target(uint8_t *buffer, int16_t width)
+{
+  if (buffer == NULL) {
+    render_buffer = frame_buffer;
+    render_width = SCREEN_WIDTH;
+  } else {
+    render_buffer = buffer;
+    render_width = width;
+  }
+}
+
 /***************************************************************************//**
  *  Set rotation for OLED SH1106.
  ******************************************************************************/
@@ -952,6 +1120,82 @@ esp_err_t sh1106_update_display()
   return status;
 }
 
+/***************************************************************************//**
+ *  Update a rectangle of the frame buffer to SH1106.
+ ******************************************************************************/
+esp_err_t sh1106_update_area(display_context_t *context,
+                             int16_t x, int16_t y, int16_t w, int16_t h)
+{
+  esp_err_t status = ESP_OK;
+  int16_t x0, y0, x1, y1;
+
+  if ((w <= 0) || (h <= 0)) {
+    return ESP_OK;
+  }
+
+  // Map the rectangle to the unrotated frame buffer
+  switch (context->rotation) {
+    case 1:
+      x0 = context->width - y - h;
+      x1 = context->width - 1 - y;
+      y0 = x;
+      y1 = x + w - 1;
+      break;
+    case 2:
+      x0 = context->width - x - w;
+      x1 = context->width - 1 - x;
+      y0 = context->height - y - h;
+      y1 = context->height - 1 - y;
+      break;
+    case 3:
+      x0 = y;
+      x1 = y + h - 1;
+      y0 = context->height - x - w;
+      y1 = context->height - 1 - x;
+      break;
+    default:
+      x0 = x;
+      x1 = x + w - 1;
+      y0 = y;
+      y1 = y + h - 1;
+      break;
+  }
+  if (x0 < 0) {
+    x0 = 0;
+  }
+  if (y0 < 0) {
+    y0 = 0;
+  }
+  if (x1 >= SCREEN_WIDTH) {
+    x1 = SCREEN_WIDTH - 1;
+  }
+  if (y1 >= SCREEN_HEIGHT) {
+    y1 = SCREEN_HEIGHT - 1;
+  }
+  if ((x0 > x1) || (y0 > y1)) {
+    return ESP_OK;
+  }
+
+  for (int i = y0 / 8; i <= y1 / 8; i++) {
+    uint8_t buffer[3];
+    buffer[0] = SH1106_SETPAGEADDR + i;
+    buffer[1] = SH1106_SETHIGHCOLUMN + ((x0 + 2) >> 4);
+    buffer[2] = SH1106_SETLOWCOLUMN + ((x0 + 2) & 0xF);
+    status |= sh1106_send_command(buffer, 3);
+    status |= sh1106_send_data(frame_buffer + 128 * i + x0, x1 - x0 + 1);
+  }
+  return status;
+}
+
+/***************************************************************************//**
+ *  Set the display start line of SH1106.
+ ******************************************************************************/
+esp_err_t sh1106_set_start_line(uint8_t line)
+{
+  uint8_t cmd = SH1106_SETSTARTLINE + (line & 0x3F);
+  return sh1106_send_command(&cmd, 1);
+}
+
 // -----------------------------------------------------------------------------
 //                         Local functions definitions
 // -----------------------------------------------------------------------------
@@ -1098,3 +1342,77 @@ static esp_err_t sh1106_draw_circle_helper(display_context_t *context,
   }
   return status;
 }
+
+/***************************************************************************//**
+ *  Extend the bounding box of a text with one character.
+ ******************************************************************************/
+static void sh1106_char_bounds(display_context_t *context, unsigned char c,
+                               int16_t *x, int16_t *y,
+                               int16_t *minx, int16_t *miny,
+                               int16_t *maxx, int16_t *maxy)
+{
+  if (!context->font) {                 // 'Classic' built-in font
+    if (c == '\n') {
+      *x = 0;
+      *y += context->textsize_y * 8;
+    } else if (c != '\r') {
+      if (context->wrap
+          && ((*x + context->textsize_x * 6) > context->width)) {
+        *x = 0;
+        *y += context->textsize_y * 8;
+      }
+      int16_t x2 = *x + context->textsize_x * 6 - 1;
+      int16_t y2 = *y + context->textsize_y * 8 - 1;
+      if (x2 > *maxx) {
+        *maxx = x2;
+      }
+      if (y2 > *maxy) {
+        *maxy = y2;
+      }
+      if (*x < *minx) {
+        *minx = *x;
+      }
+      if (*y < *miny) {
+        *miny = *y;
+      }
+      *x += context->textsize_x * 6;
+    }
+  } else {   // Custom font
+    if (c == '\n') {
+      *x = 0;
+      *y += (int16_t)context->textsize_y * (uint8_t)context->font->y_advance;
+    } else if ((c != '\r')
+               && (c >= context->font->first)
+               && (c <= context->font->last)) {
+      gfx_glyph_t *glyph = &context->font->glyph[c - context->font->first];
+      int16_t xo = glyph->x_offset;
+      int16_t yo = glyph->y_offset;
+      if (context->wrap
+          && ((*x + context->textsize_x * (xo + glyph->width))
+              > context->width)) {
+        *x = 0;
+        *y += (int16_t)context->textsize_y
+              * (uint8_t)context->font->y_advance;
+      }
+      if ((glyph->width > 0) && (glyph->height > 0)) {
+        int16_t x1 = *x + xo * context->textsize_x;
+        int16_t y1 = *y + yo * context->textsize_y;
+        int16_t x2 = x1 + glyph->width * context->textsize_x - 1;
+        int16_t y2 = y1 + glyph->height * context->textsize_y - 1;
+        if (x1 < *minx) {
+          *minx = x1;
+        }
+        if (y1 < *miny) {
+          *miny = y1;
+        }
+        if (x2 > *maxx) {
+          *maxx = x2;
+        }
+        if (y2 > *maxy) {
+          *maxy = y2;
+        }
+      }
+      *x += (uint8_t)glyph->x_advance * (int16_t)context->textsize_x;
+    }
+  }
+}
@@ -73,6 +73,13 @@ typedef struct {
   int8_t y_offset;        ///< Y dist from cursor pos to UL corner
 } gfx_glyph_t;
 
+/// Kerning adjustment for a PAIR of characters
+typedef struct {
+  uint8_t left;           ///< First character of the pair
+  uint8_t right;          ///< Second character of the pair
+  int8_t adjust;          ///< Added to x_advance of the first character
+} gfx_kern_pair_t;
+
 /// Data stored for FONT AS A WHOLE
 typedef struct {
   uint8_t *bitmap;        ///< Glyph bitmaps, concatenated
@@ -80,6 +87,8 @@ typedef struct {
   uint16_t first;         ///< ASCII extents (first char)
   uint16_t last;          ///< ASCII extents (last char)
   uint8_t y_advance;      ///< Newline distance (y axis)
+  const gfx_kern_pair_t *kern; ///< Kerning pairs sorted by (left, right)
+  uint16_t kern_count;    ///< Number of kerning pairs, 0 if none
 } gfx_font_t;
 
 /** @brief GLIB Drawing Context
@@ -455,7 +464,26 @@ esp_err_t sh1106_write_char(display_context_t *context, char c);
 
 /***************************************************************************//**
  * @brief
- *  Draw a string on SH1106 at the current position of the cursor.
+ *  Get the kerning adjustment of a pair of characters. The pair table of the
+ *  font is binary searched, so the cost grows with log2 of the table size.
+ *
+ * @param[in] font
+ *  The font, NULL for the classic built-in font which has no kerning.
+ * @param[in] left
+ *  The first character of the pair.
+ * @param[in] right
+ *  The second character of the pair.
+ *
+ * @return
+ *  The adjustment in pixels (unscaled) added to the advance of left.
+ ******************************************************************************/
+int8_t sh1106_get_kerning(const gfx_font_t *font,
+                          unsigned char left, unsigned char right);
+
+/***************************************************************************//**
+ * @brief
+ *  Draw a string on SH1106 at the current position of the cursor. Kerning
+ *  of the font, if any, is applied between consecutive characters.
  *
  * @param[in] context
  *  The pointer to current display context.
@@ -473,6 +501,34 @@ esp_err_t sh1106_write_char(display_context_t *context, char c);
 esp_err_t sh1106_write_string(display_context_t *context, const char *str,
                               int16_t x0, int16_t y0);
 
+/***************************************************************************//**
+ * @brief
+ *  Compute the bounding box of a string as it would be drawn by
+ *  sh1106_write_string() with the current font, kerning, text size and wrap
+ *  setting.
+ *
+ * @param[in] context
+ *  The pointer to current display context.
+ * @param[in] str
+ *  The string to measure.
+ * @param[in] x
+ *  Cursor position in x axis.
+ * @param[in] y
+ *  Cursor position in y axis.
+ * @param[out] x1
+ *  The top-left corner of the bounding box in x axis.
+ * @param[out] y1
+ *  The top-left corner of the bounding box in y axis.
+ * @param[out] w
+ *  The width of the bounding box.
+ * @param[out] h
+ *  The height of the bounding box.
+ ******************************************************************************/
+void sh1106_get_text_bounds(display_context_t *context, const char *str,
+                            int16_t x, int16_t y,
+                            int16_t *x1, int16_t *y1,
+                            uint16_t *w, uint16_t *h);
+
 /***************************************************************************//**
  * @brief
  *  Draw a RAM-resident 1-bit image at the specified (x,y) position
@@ -504,6 +560,50 @@ esp_err_t sh1106_draw_bitmap(display_context_t *context,
                              SH1106_PIXEL_COLOR color,
                              SH1106_PIXEL_COLOR bg);
 
+/***************************************************************************//**
+ * @brief
+ *  Draw a 1-bit image stored in page format (one byte per column, LSB on top,
+ *  w bytes per page) at the specified (x,y) position. Only set bits are
+ *  drawn. Without rotation the image is OR-ed into the frame buffer a byte at
+ *  a time.
+ *
+ * @param[in] context
+ *  The pointer to current display context.
+ * @param[in] x
+ *  Position in x axis.
+ * @param[in] y
+ *  Position in y axis.
+ * @param[in] bitmap
+ *  The page-format bitmap.
+ * @param[in] w
+ *  Width of the bitmap.
+ * @param[in] h
+ *  Height of the bitmap.
+ * @param[in] color
+ *  Color of the set bits.
+ *
+ * @return
+ *  ESP_OK            if OK.
+ *  Other return code if Failed.
+ ******************************************************************************/
+esp_err_t sh1106_draw_page_bitmap(display_context_t *context,
+                                  int16_t x, int16_t y, const uint8_t *bitmap,
+                                  int16_t w, int16_t h,
+                                  SH1106_PIXEL_COLOR color);
+
+/***************************************************************************//**
+ * @brief
+ *  Redirect all drawing functions to an off-screen buffer in page format.
+ *  The context used while drawing must carry the buffer size in its width
+ *  and height so drawing is clipped to the buffer.
+ *
+ * @param[in] buffer
+ *  The off-screen buffer, or NULL to draw to the frame buffer again.
+ * @param[in] width
+ *  Width of the off-screen buffer in pixels.
+ ******************************************************************************/
+void sh1106_set_render_target(uint8_t *buffer, int16_t width);
+
 /***************************************************************************//**
  * @brief
  *  Set rotation direction for OLED SH1106.
@@ -537,4 +637,42 @@ esp_err_t sh1106_fill_screen(display_context_t *context,
  ******************************************************************************/
 esp_err_t sh1106_update_display();
 
+/***************************************************************************//**
+ * @brief
+ *  Push only a rectangle of the frame buffer to OLED SH1106. The rectangle
+ *  is widened to whole pages vertically; only its columns are sent.
+ *
+ * @param[in] context
+ *  The pointer to current display context, used for the rotation.
+ * @param[in] x
+ *  The coordinator of top-left point in x axis.
+ * @param[in] y
+ *  The coordinator of top-left point in y axis.
+ * @param[in] w
+ *  The width of the rectangle.
+ * @param[in] h
+ *  The height of the rectangle.
+ *
+ * @return
+ *  ESP_OK            if OK.
+ *  Other return code if Failed.
+ ******************************************************************************/
+esp_err_t sh1106_update_area(display_context_t *context,
+                             int16_t x, int16_t y, int16_t w, int16_t h);
+
+/***************************************************************************//**
+ * @brief
+ *  Set the RAM line shown on the top row of the panel. Moving it by a
+ *  multiple of 8 scrolls the display by whole pages without resending the
+ *  frame buffer.
+ *
+ * @param[in] line
+ *  The display start line, 0 to 63.
+ *
+ * @return
+ *  ESP_OK            if OK.
+ *  Other return code if Failed.
+ ******************************************************************************/
+esp_err_t sh1106_set_start_line(uint8_t line);
+
 #endif /* _SH1106_H_ */
@@ -0,0 +1,366 @@
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "sh1106_console.h"
+
+// -----------------------------------------------------------------------------
+//                               Macros
+// -----------------------------------------------------------------------------
+
+#define ESC                     0x1B
+#define TAB_WIDTH               4
+
+// -----------------------------------------------------------------------------
+//                               Local variables
+// -----------------------------------------------------------------------------
+
+static display_context_t console_context;
+static SemaphoreHandle_t console_lock;          // cell grid and cursor
+static SemaphoreHandle_t console_flush_lock;    // one flush at a time
+
+/* cells are indexed by frame buffer page, not by screen row */
+static unsigned char console_cell[SH1106_CONSOLE_ROWS][SH1106_CONSOLE_COLS];
+/* owned by the flush: the copy being sent and what SH1106 shows */
+static unsigned char console_sent[SH1106_CONSOLE_ROWS][SH1106_CONSOLE_COLS];
+static unsigned char console_shown[SH1106_CONSOLE_ROWS][SH1106_CONSOLE_COLS];
+static uint8_t console_dirty;           // one bit per page
+static uint8_t console_top;             // page shown on the top row
+static uint8_t console_shown_top;       // top page set on SH1106
+static uint8_t console_row;             // cursor row on screen
+static uint8_t console_col;             // cursor column
+static uint8_t console_escape;          // ANSI escape parser state
+
+static vprintf_like_t console_prev_vprintf;
+
+// -----------------------------------------------------------------------------
+//                            Local functions declaration
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ * @brief
+ *  Put one character in the cell grid. Caller holds console_lock.
+ *
+ * @param[in] c
+ *  The character to put.
+ ******************************************************************************/
+static void sh1106_console_put(unsigned char c);
+
+/***************************************************************************//**
+ * @brief
+ *  Move the cursor to the next line, scrolling by one page at the bottom.
+ ******************************************************************************/
+static void sh1106_console_newline(void);
+
+/***************************************************************************//**
+ * @brief
+ *  Blank one page of the cell grid.
+ *
+ * @param[in] page
+ *  The page to blank.
+ ******************************************************************************/
+static void sh1106_console_blank_page(uint8_t page);
+
+/***************************************************************************//**
+ * @brief
+ *  esp_log output hook, forwards to the previous output and the console.
+ ******************************************************************************/
+static int sh1106_console_log_vprintf(const char *fmt, va_list args);
+
+// -----------------------------------------------------------------------------
+//                               Public functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Start the console.
+ ******************************************************************************/
+esp_err_t sh1106_console_init(void)
+{
+  if (console_flush_lock == NULL) {
+    console_flush_lock = xSemaphoreCreateMutex();
+    if (console_flush_lock == NULL) {
+      return ESP_ERR_NO_MEM;
+    }
+  }
+  if (console_lock == NULL) {
+    console_lock = xSemaphoreCreateMutex();
+    if (console_lock == NULL) {
+      return ESP_ERR_NO_MEM;
+    }
+  }
+
+  memset(&console_context, 0, sizeof(console_context));
+  console_context.width = SCREEN_WIDTH;
+  console_context.height = SCREEN_HEIGHT;
+  console_context.text_color = WHITE;
+  console_context.bg_color = BLACK;
+  console_context.textsize_x = console_context.textsize_y = 1;
+  console_context.rotation = origin;
+
+  // Nothing is known about the panel content, repaint every cell once
+  memset(console_shown, 0, sizeof(console_shown));
+  console_top = 0;
+  console_shown_top = 0;
+  sh1106_console_clear();
+  return sh1106_set_start_line(0);
+}
+
+/***************************************************************************//**
+ *  Stop the console.
+ ******************************************************************************/
+esp_err_t sh1106_console_deinit(void)
+{
+  sh1106_console_redirect_log(false);
+  console_shown_top = 0;
+  return sh1106_set_start_line(0);
+}
+
+/***************************************************************************//**
+ *  Clear the console.
+ ******************************************************************************/
+esp_err_t sh1106_console_clear(void)
+{
+  if (console_lock == NULL) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  xSemaphoreTake(console_lock, portMAX_DELAY);
+  for (uint8_t page = 0; page < SH1106_CONSOLE_ROWS; page++) {
+    sh1106_console_blank_page(page);
+  }
+  console_row = console_col = 0;
+  console_escape = 0;
+  xSemaphoreGive(console_lock);
+  return ESP_OK;
+}
+
+/***************************************************************************//**
+ *  Write characters to the console.
+ ******************************************************************************/
+esp_err_t sh1106_console_write(const char *str, size_t len)
+{
+  if (console_lock == NULL) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  xSemaphoreTake(console_lock, portMAX_DELAY);
+  while (len--) {
+    sh1106_console_put((unsigned char)*str++);
+  }
+  xSemaphoreGive(console_lock);
+  return ESP_OK;
+}
+
+/***************************************************************************//**
+ *  Formatted write to the console.
+ ******************************************************************************/
+int sh1106_console_printf(const char *fmt, ...)
+{
+  va_list args;
+  int len;
+
+  va_start(args, fmt);
+  len = sh1106_console_vprintf(fmt, args);
+  va_end(args);
+  return len;
+}
+
+/***************************************************************************//**
+ *  Formatted write to the console with a va_list.
+ ******************************************************************************/
+int sh1106_console_vprintf(const char *fmt, va_list args)
+{
+  char line[SH1106_CONSOLE_LINE_MAX];
+  int len = vsnprintf(line, sizeof(line), fmt, args);
+
+  if (len < 0) {
+    return len;
+  }
+  if (len >= (int)sizeof(line)) {
+    len = sizeof(line) - 1;
+  }
+  if (sh1106_console_write(line, len) != ESP_OK) {
+    return -1;
+  }
+  return len;
+}
+
+/***************************************************************************//**
+ *  Render and send the cells that changed.
+ ******************************************************************************/
+esp_err_t sh1106_console_flush(void)
+{
+  esp_err_t status = ESP_OK;
+  uint8_t dirty, top;
+
+  if (console_lock == NULL) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  xSemaphoreTake(console_flush_lock, portMAX_DELAY);
+
+  // Copy the dirty pages, writers and the log hook never wait for I2C
+  xSemaphoreTake(console_lock, portMAX_DELAY);
+  dirty = console_dirty;
+  top = console_top;
+  for (uint8_t page = 0; page < SH1106_CONSOLE_ROWS; page++) {
+    if (dirty & (1 << page)) {
+      memcpy(console_sent[page], console_cell[page], SH1106_CONSOLE_COLS);
+    }
+  }
+  console_dirty = 0;
+  xSemaphoreGive(console_lock);
+
+  for (uint8_t page = 0; page < SH1106_CONSOLE_ROWS; page++) {
+    int16_t first = -1, last = -1;
+
+    if (!(dirty & (1 << page))) {
+      continue;
+    }
+    for (uint8_t col = 0; col < SH1106_CONSOLE_COLS; col++) {
+      unsigned char c = console_sent[page][col];
+      if (c == console_shown[page][col]) {
+        continue;
+      }
+      status |= sh1106_draw_char(&console_context,
+                                 col * SH1106_CONSOLE_CELL_WIDTH,
+                                 page * SH1106_CONSOLE_CELL_HEIGHT,
+                                 c, WHITE, BLACK, 1, 1);
+      console_shown[page][col] = c;
+      if (first < 0) {
+        first = col;
+      }
+      last = col;
+    }
+    if (first >= 0) {
+      status |= sh1106_update_area(&console_context,
+                                   first * SH1106_CONSOLE_CELL_WIDTH,
+                                   page * SH1106_CONSOLE_CELL_HEIGHT,
+                                   (last - first + 1)
+                                   * SH1106_CONSOLE_CELL_WIDTH,
+                                   SH1106_CONSOLE_CELL_HEIGHT);
+    }
+  }
+
+  // Scroll after the new bottom line is in place
+  if (top != console_shown_top) {
+    status |= sh1106_set_start_line(top * SH1106_CONSOLE_CELL_HEIGHT);
+    console_shown_top = top;
+  }
+  xSemaphoreGive(console_flush_lock);
+  return status;
+}
+
+/***************************************************************************//**
+ *  Redirect ESP log output to the console.
+ ******************************************************************************/
+void sh1106_console_redirect_log(bool enable)
+{
+  if (enable && (console_prev_vprintf == NULL)) {
+    console_prev_vprintf = esp_log_set_vprintf(sh1106_console_log_vprintf);
+  } else if (!enable && (console_prev_vprintf != NULL)) {
+    esp_log_set_vprintf(console_prev_vprintf);
+    console_prev_vprintf = NULL;
+  }
+}
+
+// -----------------------------------------------------------------------------
+//                         Local functions definitions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Put one character in the cell grid.
+ ******************************************************************************/
+static void sh1106_console_put(unsigned char c)
+{
+  uint8_t page;
+
+  // Skip ANSI escape sequences: ESC '[' parameters final-byte
+  if (console_escape == 1) {
+    console_escape = (c == '[') ? 2 : 0;
+    return;
+  }
+  if (console_escape == 2) {
+    if ((c >= 0x40) && (c <= 0x7E)) {
+      console_escape = 0;
+    }
+    return;
+  }
+
+  switch (c) {
+    case ESC:
+      console_escape = 1;
+      return;
+    case '\n':
+      sh1106_console_newline();
+      return;
+    case '\r':
+      console_col = 0;
+      return;
+    case '\b':
+      if (console_col > 0) {
+        console_col--;
+      }
+      return;
+    case '\t':
+      do {
+        sh1106_console_put(' ');
+      } while (console_col % TAB_WIDTH);
+      return;
+    default:
+      break;
+  }
+
+  if (console_col >= SH1106_CONSOLE_COLS) {
+    sh1106_console_newline();
+  }
+  page = (console_top + console_row) % SH1106_CONSOLE_ROWS;
+  if (console_cell[page][console_col] != c) {
+    console_cell[page][console_col] = c;
+    console_dirty |= 1 << page;
+  }
+  console_col++;
+}
+
+/***************************************************************************//**
+ *  Move the cursor to the next line.
+ ******************************************************************************/
+static void sh1106_console_newline(void)
+{
+  console_col = 0;
+  if (console_row < SH1106_CONSOLE_ROWS - 1) {
+    console_row++;
+    return;
+  }
+  // The page leaving the top becomes the new bottom line
+  sh1106_console_blank_page(console_top);
+  console_top = (console_top + 1) % SH1106_CONSOLE_ROWS;
+}
+
+/***************************************************************************//**
+ *  Blank one page of the cell grid.
+ ******************************************************************************/
+static void sh1106_console_blank_page(uint8_t page)
+{
+  memset(console_cell[page], ' ', SH1106_CONSOLE_COLS);
+  console_dirty |= 1 << page;
+}
+
+/***************************************************************************//**
+ *  esp_log output hook.
+ ******************************************************************************/
+static int sh1106_console_log_vprintf(const char *fmt, va_list args)
+{
+  va_list copy;
+  int len;
+
+  va_copy(copy, args);
+  len = console_prev_vprintf(fmt, copy);
+  va_end(copy);
+  // console_lock is never held across I2C, so a log from the I2C driver
+  // during a flush waits for a copy, not for the transfers
+  sh1106_console_vprintf(fmt, args);
+  return len;
+}
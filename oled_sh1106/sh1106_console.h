@@ -0,0 +1,130 @@
+#ifndef _SH1106_CONSOLE_H_
+#define _SH1106_CONSOLE_H_
+
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdarg.h>
+#include "esp_err.h"
+#include "sh1106.h"
+
+// -----------------------------------------------------------------------------
+//                               Macros and Typedefs
+// -----------------------------------------------------------------------------
+
+/* character cell of the classic 5x7 font, one page high */
+#define SH1106_CONSOLE_CELL_WIDTH               6
+#define SH1106_CONSOLE_CELL_HEIGHT              8
+
+/* size of the console grid */
+#define SH1106_CONSOLE_COLS     (SCREEN_WIDTH / SH1106_CONSOLE_CELL_WIDTH)
+#define SH1106_CONSOLE_ROWS     (SCREEN_HEIGHT / SH1106_CONSOLE_CELL_HEIGHT)
+
+/* longest formatted output of one printf call */
+#define SH1106_CONSOLE_LINE_MAX                 128
+
+// -----------------------------------------------------------------------------
+//                               Public functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ * @brief
+ *  Start the console. The console owns the whole screen: it draws with the
+ *  classic 5x7 font, no rotation, and scrolls with the display start line.
+ *  sh1106_init() must be called first.
+ *
+ * @return
+ *  ESP_OK            if OK.
+ *  Other return code if Failed.
+ ******************************************************************************/
+esp_err_t sh1106_console_init(void);
+
+/***************************************************************************//**
+ * @brief
+ *  Stop the console, stop log redirection and restore the start line.
+ *
+ * @return
+ *  ESP_OK            if OK.
+ *  Other return code if Failed.
+ ******************************************************************************/
+esp_err_t sh1106_console_deinit(void);
+
+/***************************************************************************//**
+ * @brief
+ *  Clear the console and move the cursor to the top-left cell.
+ *
+ * @return
+ *  ESP_OK                if OK.
+ *  ESP_ERR_INVALID_STATE if the console is not started.
+ ******************************************************************************/
+esp_err_t sh1106_console_clear(void);
+
+/***************************************************************************//**
+ * @brief
+ *  Write characters to the console. '\n', '\r', '\b' and '\t' are handled
+ *  and ANSI escape sequences (e.g. log colors) are skipped. Only the cell
+ *  grid is updated, call sh1106_console_flush() to show it.
+ *
+ * @param[in] str
+ *  The characters to write.
+ * @param[in] len
+ *  The number of characters.
+ *
+ * @return
+ *  ESP_OK                if OK.
+ *  ESP_ERR_INVALID_STATE if the console is not started.
+ ******************************************************************************/
+esp_err_t sh1106_console_write(const char *str, size_t len);
+
+/***************************************************************************//**
+ * @brief
+ *  Formatted write to the console.
+ *
+ * @param[in] fmt
+ *  printf-style format string.
+ *
+ * @return
+ *  The number of characters written, negative if the console is not started.
+ ******************************************************************************/
+int sh1106_console_printf(const char *fmt, ...);
+
+/***************************************************************************//**
+ * @brief
+ *  Formatted write to the console with a va_list. Output longer than
+ *  SH1106_CONSOLE_LINE_MAX characters is truncated.
+ *
+ * @param[in] fmt
+ *  printf-style format string.
+ * @param[in] args
+ *  The arguments of the format string.
+ *
+ * @return
+ *  The number of characters written, negative if the console is not started.
+ ******************************************************************************/
+int sh1106_console_vprintf(const char *fmt, va_list args);
+
+/***************************************************************************//**
+ * @brief
+ *  Render the cells that changed since the last flush and send only their
+ *  columns to SH1106, then apply a pending scroll.
+ *
+ * @return
+ *  ESP_OK                if OK.
+ *  ESP_ERR_INVALID_STATE if the console is not started.
+ *  Other return code     if Failed.
+ ******************************************************************************/
+esp_err_t sh1106_console_flush(void);
+
+/***************************************************************************//**
+ * @brief
+ *  Redirect ESP log output to the console. The previous log output keeps
+ *  receiving every message.
+ *
+ * @param[in] enable
+ *  true to redirect, false to restore the previous log output.
+ ******************************************************************************/
+void sh1106_console_redirect_log(bool enable);
+
+#endif /* _SH1106_CONSOLE_H_ */
@@ -0,0 +1,292 @@
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include "sh1106_digits.h"
+
+// -----------------------------------------------------------------------------
+//                               Macros
+// -----------------------------------------------------------------------------
+
+/* segment bits: a is the top segment, then clockwise, g is the middle one */
+#define SEG_A                   0x01
+#define SEG_B                   0x02
+#define SEG_C                   0x04
+#define SEG_D                   0x08
+#define SEG_E                   0x10
+#define SEG_F                   0x20
+#define SEG_G                   0x40
+
+#define is_narrow(c)            (((c) == ':') || ((c) == '.'))
+
+// -----------------------------------------------------------------------------
+//                               Local variables
+// -----------------------------------------------------------------------------
+
+static const uint8_t segment_map[16] = {
+  0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07,   // 0-7
+  0x7F, 0x6F, 0x77, 0x7C, 0x39, 0x5E, 0x79, 0x71,   // 8-9, A-F
+};
+
+// -----------------------------------------------------------------------------
+//                            Local functions declaration
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ * @brief
+ *  Get the segments lit for a character.
+ *
+ * @param[in] c
+ *  The character.
+ *
+ * @return
+ *  Segment bits, 0 for a blank cell.
+ ******************************************************************************/
+static uint8_t sh1106_digits_segments(char c);
+
+/***************************************************************************//**
+ * @brief
+ *  Clear one cell and its trailing gap, then draw the character in it.
+ *
+ * @return
+ *  ESP_OK            if OK.
+ *  Other return code if Failed.
+ ******************************************************************************/
+static esp_err_t sh1106_digits_draw_cell(display_context_t *context,
+                                         const sh1106_digits_t *digits,
+                                         int16_t x, uint8_t w, char c);
+
+// -----------------------------------------------------------------------------
+//                               Public functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Initialize a seven-segment numeric display.
+ ******************************************************************************/
+void sh1106_digits_init_segment(sh1106_digits_t *digits,
+                                int16_t x, int16_t y,
+                                uint8_t w, uint8_t h,
+                                uint8_t thickness, uint8_t spacing)
+{
+  memset(digits, 0, sizeof(*digits));
+  digits->style = SH1106_DIGITS_SEVEN_SEGMENT;
+  digits->x = x;
+  digits->y = y;
+  digits->cell_w = w;
+  digits->cell_h = h;
+  digits->narrow_w = 3 * thickness;
+  digits->thickness = thickness;
+  digits->spacing = spacing;
+}
+
+/***************************************************************************//**
+ *  Initialize a numeric display drawn with a magnified font.
+ ******************************************************************************/
+esp_err_t sh1106_digits_init_font(sh1106_digits_t *digits,
+                                  int16_t x, int16_t y,
+                                  const gfx_font_t *font, uint8_t scale,
+                                  uint8_t spacing)
+{
+  // The cell size comes from '0' and ':', which are next to each other
+  if (font && ((font->first > '0') || (font->last < ':'))) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  memset(digits, 0, sizeof(*digits));
+  digits->style = SH1106_DIGITS_FONT;
+  digits->x = x;
+  digits->y = y;
+  digits->font = font;
+  digits->scale = scale;
+  digits->spacing = spacing;
+
+  if (!font) {   // 'Classic' built-in font, fixed 6x8 cells
+    digits->cell_w = digits->narrow_w = 6 * scale;
+    digits->cell_h = 8 * scale;
+  } else {
+    const gfx_glyph_t *zero = &font->glyph['0' - font->first];
+    const gfx_glyph_t *colon = &font->glyph[':' - font->first];
+    digits->cell_w = zero->x_advance * scale;
+    digits->narrow_w = colon->x_advance * scale;
+    digits->cell_h = zero->height * scale;
+    digits->baseline = -zero->y_offset * scale;
+  }
+  return ESP_OK;
+}
+
+/***************************************************************************//**
+ *  Show a value, redrawing only the cells that changed.
+ ******************************************************************************/
+esp_err_t sh1106_digits_show(display_context_t *context,
+                             sh1106_digits_t *digits, const char *text)
+{
+  esp_err_t status = ESP_OK;
+  size_t len = strlen(text);
+  int16_t cx = digits->x;
+  int16_t run_x = 0, run_end = 0;
+  int16_t old_end = digits->x;
+  bool run = false;
+
+  if (len > SH1106_DIGITS_MAX) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (digits->shown_len) {
+    char last = digits->shown[digits->shown_len - 1];
+    old_end = digits->shown_x[digits->shown_len - 1] + digits->spacing
+              + (is_narrow(last) ? digits->narrow_w : digits->cell_w);
+  }
+
+  for (uint8_t i = 0; i < len; i++) {
+    char c = text[i];
+    uint8_t w = is_narrow(c) ? digits->narrow_w : digits->cell_w;
+    bool changed = (i >= digits->shown_len) || (digits->shown[i] != c)
+                   || (digits->shown_x[i] != cx);
+
+    if (changed) {
+      status |= sh1106_digits_draw_cell(context, digits, cx, w, c);
+      digits->shown[i] = c;
+      digits->shown_x[i] = cx;
+      if (!run) {
+        run_x = cx;
+        run = true;
+      }
+      run_end = cx + w + digits->spacing;
+    } else if (run) {
+      // Send consecutive changed cells in one transfer per page
+      status |= sh1106_update_area(context, run_x, digits->y,
+                                   run_end - run_x, digits->cell_h);
+      run = false;
+    }
+    cx += w + digits->spacing;
+  }
+
+  // Erase what is left of a longer previous value
+  if (old_end > cx) {
+    status |= sh1106_draw_fill_rectangle(context, cx, digits->y,
+                                         old_end - cx, digits->cell_h,
+                                         context->bg_color);
+    if (!run) {
+      run_x = cx;
+      run = true;
+    }
+    run_end = old_end;
+  }
+  if (run) {
+    status |= sh1106_update_area(context, run_x, digits->y,
+                                 run_end - run_x, digits->cell_h);
+  }
+  digits->shown[len] = '\0';
+  digits->shown_len = len;
+  return status;
+}
+
+/***************************************************************************//**
+ *  Forget what is on the panel.
+ ******************************************************************************/
+void sh1106_digits_invalidate(sh1106_digits_t *digits)
+{
+  digits->shown_len = 0;
+  digits->shown[0] = '\0';
+}
+
+// -----------------------------------------------------------------------------
+//                         Local functions definitions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Get the segments lit for a character.
+ ******************************************************************************/
+static uint8_t sh1106_digits_segments(char c)
+{
+  if ((c >= '0') && (c <= '9')) {
+    return segment_map[c - '0'];
+  }
+  if ((c >= 'A') && (c <= 'F')) {
+    return segment_map[c - 'A' + 10];
+  }
+  if ((c >= 'a') && (c <= 'f')) {
+    return segment_map[c - 'a' + 10];
+  }
+  if (c == '-') {
+    return SEG_G;
+  }
+  return 0;
+}
+
+/***************************************************************************//**
+ *  Clear one cell and draw a character in it.
+ ******************************************************************************/
+static esp_err_t sh1106_digits_draw_cell(display_context_t *context,
+                                         const sh1106_digits_t *digits,
+                                         int16_t x, uint8_t w, char c)
+{
+  esp_err_t status = ESP_OK;
+  SH1106_PIXEL_COLOR ink = context->text_color;
+  int16_t y = digits->y;
+  int16_t h = digits->cell_h;
+  int16_t t = digits->thickness;
+
+  status |= sh1106_draw_fill_rectangle(context, x, y, w + digits->spacing, h,
+                                       context->bg_color);
+
+  if (digits->style == SH1106_DIGITS_FONT) {
+    const gfx_font_t *font = digits->font;
+    if (!font) {
+      status |= sh1106_draw_char(context, x, y, c, ink, context->bg_color,
+                                 digits->scale, digits->scale);
+    } else if ((c >= font->first) && (c <= font->last)) {
+      status |= sh1106_draw_char(context, x, y + digits->baseline, c,
+                                 ink, context->bg_color,
+                                 digits->scale, digits->scale);
+    }
+    return status;
+  }
+
+  if (c == ':') {
+    status |= sh1106_draw_fill_rectangle(context, x + t, y + h / 3 - t / 2,
+                                         t, t, ink);
+    status |= sh1106_draw_fill_rectangle(context,
+                                         x + t, y + 2 * h / 3 - t / 2,
+                                         t, t, ink);
+  } else if (c == '.') {
+    status |= sh1106_draw_fill_rectangle(context, x + t, y + h - t,
+                                         t, t, ink);
+  } else {
+    uint8_t seg = sh1106_digits_segments(c);
+    int16_t upper = (h - 3 * t) / 2;        // Height of an upper vertical
+    int16_t lower = h - 3 * t - upper;      // Height of a lower vertical
+    int16_t mid = y + t + upper;            // Top of the middle segment
+
+    if (seg & SEG_A) {
+      status |= sh1106_draw_fill_rectangle(context, x + t, y,
+                                           w - 2 * t, t, ink);
+    }
+    if (seg & SEG_B) {
+      status |= sh1106_draw_fill_rectangle(context, x + w - t, y + t,
+                                           t, upper, ink);
+    }
+    if (seg & SEG_C) {
+      status |= sh1106_draw_fill_rectangle(context, x + w - t, mid + t,
+                                           t, lower, ink);
+    }
+    if (seg & SEG_D) {
+      status |= sh1106_draw_fill_rectangle(context, x + t, y + h - t,
+                                           w - 2 * t, t, ink);
+    }
+    if (seg & SEG_E) {
+      status |= sh1106_draw_fill_rectangle(context, x, mid + t,
+                                           t, lower, ink);
+    }
+    if (seg & SEG_F) {
+      status |= sh1106_draw_fill_rectangle(context, x, y + t,
+                                           t, upper, ink);
+    }
+    if (seg & SEG_G) {
+      status |= sh1106_draw_fill_rectangle(context, x + t, mid,
+                                           w - 2 * t, t, ink);
+    }
+  }
+  return status;
+}
@@ -0,0 +1,130 @@
+#ifndef _SH1106_DIGITS_H_
+#define _SH1106_DIGITS_H_
+
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include "esp_err.h"
+#include "sh1106.h"
+
+// -----------------------------------------------------------------------------
+//                               Macros and Typedefs
+// -----------------------------------------------------------------------------
+
+/* maximum number of characters of one numeric display */
+#define SH1106_DIGITS_MAX                       12
+
+/* rendering style of a numeric display */
+typedef enum {
+  SH1106_DIGITS_SEVEN_SEGMENT = 0, /* segments drawn with filled rectangles */
+  SH1106_DIGITS_FONT          = 1, /* glyphs of a font, magnified */
+} sh1106_digits_style_t;
+
+/** @brief Numeric display state
+ *  Remembers what is on the panel so only changed cells are redrawn.
+ */
+typedef struct {
+  sh1106_digits_style_t style; ///< Rendering style
+  int16_t x;              ///< Top-left corner in x axis
+  int16_t y;              ///< Top-left corner in y axis
+  uint8_t cell_w;         ///< Width of a digit cell
+  uint8_t cell_h;         ///< Height of a digit cell
+  uint8_t narrow_w;       ///< Width of a ':' or '.' cell
+  uint8_t thickness;      ///< Segment thickness (seven segment style)
+  uint8_t spacing;        ///< Gap between cells
+  const gfx_font_t *font; ///< Font (font style), NULL for the classic font
+  uint8_t scale;          ///< Font magnification (font style)
+  int16_t baseline;       ///< Baseline offset from y (custom font style)
+  char shown[SH1106_DIGITS_MAX + 1];  ///< Characters on the panel
+  int16_t shown_x[SH1106_DIGITS_MAX]; ///< Cell positions on the panel
+  uint8_t shown_len;      ///< Number of cells on the panel
+} sh1106_digits_t;
+
+// -----------------------------------------------------------------------------
+//                               Public functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ * @brief
+ *  Initialize a seven-segment numeric display.
+ *
+ * @param[out] digits
+ *  The numeric display to initialize.
+ * @param[in] x
+ *  The coordinator of top-left point in x axis.
+ * @param[in] y
+ *  The coordinator of top-left point in y axis.
+ * @param[in] w
+ *  The width of a digit.
+ * @param[in] h
+ *  The height of a digit.
+ * @param[in] thickness
+ *  The thickness of a segment.
+ * @param[in] spacing
+ *  The gap between two cells.
+ ******************************************************************************/
+void sh1106_digits_init_segment(sh1106_digits_t *digits,
+                                int16_t x, int16_t y,
+                                uint8_t w, uint8_t h,
+                                uint8_t thickness, uint8_t spacing);
+
+/***************************************************************************//**
+ * @brief
+ *  Initialize a numeric display drawn with a magnified font. The cell size
+ *  is taken from the '0' and ':' glyphs so every digit has the same width.
+ *
+ * @param[out] digits
+ *  The numeric display to initialize.
+ * @param[in] x
+ *  The coordinator of top-left point in x axis.
+ * @param[in] y
+ *  The coordinator of top-left point in y axis.
+ * @param[in] font
+ *  The font, NULL for the classic built-in font.
+ * @param[in] scale
+ *  Magnification of the font.
+ * @param[in] spacing
+ *  The gap between two cells.
+ *
+ * @return
+ *  ESP_OK              if OK.
+ *  ESP_ERR_INVALID_ARG if the font has no '0' to '9' or ':' glyph.
+ ******************************************************************************/
+esp_err_t sh1106_digits_init_font(sh1106_digits_t *digits,
+                                  int16_t x, int16_t y,
+                                  const gfx_font_t *font, uint8_t scale,
+                                  uint8_t spacing);
+
+/***************************************************************************//**
+ * @brief
+ *  Show a value. Only cells whose character or position changed since the
+ *  last call are cleared, redrawn and sent to SH1106.
+ *
+ * @param[in] context
+ *  The pointer to current display context.
+ * @param[in] digits
+ *  The numeric display.
+ * @param[in] text
+ *  The characters to show: '0'-'9', 'A'-'F', '-', ':', '.' and ' '.
+ *
+ * @return
+ *  ESP_OK              if OK.
+ *  ESP_ERR_INVALID_ARG if the text is longer than SH1106_DIGITS_MAX.
+ *  Other return code if Failed.
+ ******************************************************************************/
+esp_err_t sh1106_digits_show(display_context_t *context,
+                             sh1106_digits_t *digits, const char *text);
+
+/***************************************************************************//**
+ * @brief
+ *  Forget what is on the panel so the next sh1106_digits_show() redraws
+ *  every cell, e.g. after the screen was cleared.
+ *
+ * @param[in] digits
+ *  The numeric display.
+ ******************************************************************************/
+void sh1106_digits_invalidate(sh1106_digits_t *digits);
+
+#endif /* _SH1106_DIGITS_H_ */
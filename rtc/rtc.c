@@ -0,0 +1,210 @@
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "rtc.h"
+
+// -----------------------------------------------------------------------------
+//                               Macros
+// -----------------------------------------------------------------------------
+
+#define ACK_EN              0x01
+
+// -----------------------------------------------------------------------------
+//                               Local functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Read registers over I2C.
+ ******************************************************************************/
+static esp_err_t rtc_i2c_read(void *ctx, uint8_t addr, uint8_t reg,
+                              uint8_t *data, size_t len)
+{
+    esp_err_t status;
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+
+    ESP_ERROR_CHECK(i2c_master_start(cmd));
+    ESP_ERROR_CHECK(i2c_master_write_byte(cmd,
+                                          (addr << 1) | I2C_MASTER_WRITE,
+                                          ACK_EN));
+    ESP_ERROR_CHECK(i2c_master_write_byte(cmd, reg, ACK_EN));
+
+    // Repeat start
+    ESP_ERROR_CHECK(i2c_master_start(cmd));
+    ESP_ERROR_CHECK(i2c_master_write_byte(cmd,
+                                          (addr << 1) | I2C_MASTER_READ,
+                                          ACK_EN));
+    if(len > 1) {
+        ESP_ERROR_CHECK(i2c_master_read(cmd, data, len - 1, I2C_MASTER_ACK));
+    }
+    ESP_ERROR_CHECK(i2c_master_read(cmd, data + len - 1, 1,
+                                    I2C_MASTER_NACK));
+    ESP_ERROR_CHECK(i2c_master_stop(cmd));
+
+    status = i2c_master_cmd_begin((i2c_port_t)(intptr_t)ctx,
+                                  cmd,
+                                  pdMS_TO_TICKS(1000));
+    i2c_cmd_link_delete(cmd);
+
+    return status;
+}
+
+/***************************************************************************//**
+ *  Write registers over I2C.
+ ******************************************************************************/
+static esp_err_t rtc_i2c_write(void *ctx, uint8_t addr, uint8_t reg,
+                               const uint8_t *data, size_t len)
+{
+    esp_err_t status;
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+
+    ESP_ERROR_CHECK(i2c_master_start(cmd));
+    ESP_ERROR_CHECK(i2c_master_write_byte(cmd,
+                                          (addr << 1) | I2C_MASTER_WRITE,
+                                          ACK_EN));
+    ESP_ERROR_CHECK(i2c_master_write_byte(cmd, reg, ACK_EN));
+    ESP_ERROR_CHECK(i2c_master_write(cmd, data, len, ACK_EN));
+    ESP_ERROR_CHECK(i2c_master_stop(cmd));
+
+    status = i2c_master_cmd_begin((i2c_port_t)(intptr_t)ctx,
+                                  cmd,
+                                  pdMS_TO_TICKS(1000));
+    i2c_cmd_link_delete(cmd);
+
+    return status;
+}
+
+// -----------------------------------------------------------------------------
+//                               Public functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Make an I2C bus.
+ ******************************************************************************/
+void rtc_bus_i2c(i2c_port_t i2c_num, rtc_bus_t *bus)
+{
+    bus->read = rtc_i2c_read;
+    bus->write = rtc_i2c_write;
+    bus->ctx = (void *)(intptr_t)i2c_num;
+}
+
+/***************************************************************************//**
+ *  Initialize an RTC.
+ ******************************************************************************/
+void rtc_init(rtc_dev_t *dev, const rtc_ops_t *ops, const rtc_bus_t *bus)
+{
+    dev->ops = ops;
+    dev->bus = *bus;
+}
+
+/***************************************************************************//**
+ *  Get date and time.
+ ******************************************************************************/
+esp_err_t rtc_get_time(const rtc_dev_t *dev, date_time_t *dt)
+{
+    esp_err_t status = dev->ops->get_time(dev, dt);
+
+    if((status == ESP_OK) || (status == ESP_ERR_INVALID_STATE)) {
+        dt->day_of_week = rtc_day_of_week(dt->year, dt->month, dt->date);
+    }
+    return status;
+}
+
+/***************************************************************************//**
+ *  Set date and time.
+ ******************************************************************************/
+esp_err_t rtc_set_time(const rtc_dev_t *dev, const date_time_t *dt)
+{
+    date_time_t check;
+
+    if((dt->year < 2000) || (dt->year > dev->ops->year_max)
+       || (dt->month < 1) || (dt->month > 12) || (dt->date < 1)
+       || (dt->hour > 23) || (dt->minute > 59) || (dt->second > 59)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // A date past the end of its month comes back as the next month
+    rtc_epoch_to_date_time(rtc_date_time_to_epoch(dt), &check);
+    if(check.date != dt->date) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return dev->ops->set_time(dev, dt);
+}
+
+/***************************************************************************//**
+ *  Read consecutive registers.
+ ******************************************************************************/
+esp_err_t rtc_read_registers(const rtc_dev_t *dev, uint8_t reg,
+                             uint8_t *data, size_t len)
+{
+    if((len == 0) || (reg >= dev->ops->reg_count)
+       || (len > dev->ops->reg_count - reg)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return dev->bus.read(dev->bus.ctx, dev->ops->address, reg, data, len);
+}
+
+/***************************************************************************//**
+ *  Write consecutive registers.
+ ******************************************************************************/
+esp_err_t rtc_write_registers(const rtc_dev_t *dev, uint8_t reg,
+                              const uint8_t *data, size_t len)
+{
+    if((len == 0) || (reg >= dev->ops->reg_count)
+       || (len > dev->ops->reg_count - reg)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return dev->bus.write(dev->bus.ctx, dev->ops->address, reg, data, len);
+}
+
+/***************************************************************************//**
+ *  Set and enable the alarm.
+ ******************************************************************************/
+esp_err_t rtc_set_alarm(const rtc_dev_t *dev, const rtc_alarm_t *alarm)
+{
+    if(dev->ops->set_alarm == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if(((alarm->second > 59) && (alarm->second != RTC_ALARM_ANY))
+       || ((alarm->minute > 59) && (alarm->minute != RTC_ALARM_ANY))
+       || ((alarm->hour > 23) && (alarm->hour != RTC_ALARM_ANY))
+       || (((alarm->date < 1) || (alarm->date > 31))
+           && (alarm->date != RTC_ALARM_ANY))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return dev->ops->set_alarm(dev, alarm);
+}
+
+/***************************************************************************//**
+ *  Disable the alarm.
+ ******************************************************************************/
+esp_err_t rtc_disable_alarm(const rtc_dev_t *dev)
+{
+    if(dev->ops->disable_alarm == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return dev->ops->disable_alarm(dev);
+}
+
+/***************************************************************************//**
+ *  Check and clear the alarm flag.
+ ******************************************************************************/
+esp_err_t rtc_check_alarm(const rtc_dev_t *dev, bool *fired)
+{
+    if(dev->ops->check_alarm == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return dev->ops->check_alarm(dev, fired);
+}
+
+/***************************************************************************//**
+ *  Get the temperature of the chip.
+ ******************************************************************************/
+esp_err_t rtc_get_temperature(const rtc_dev_t *dev, int16_t *temp)
+{
+    if(dev->ops->get_temperature == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return dev->ops->get_temperature(dev, temp);
+}
@@ -0,0 +1,246 @@
+#ifndef _RTC_H_
+#define _RTC_H_
+
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/i2c.h"
+#include "rtc_time.h"
+
+// -----------------------------------------------------------------------------
+//                               Macros
+// -----------------------------------------------------------------------------
+
+// alarm field that matches any value
+#define RTC_ALARM_ANY       0xFF
+
+// convert BCD format to Binary format
+#define RTC_BCD_2_BIN(x)    ((x) - 6 * ((x) >> 4))
+// convert Binary format to BCD format
+#define RTC_BIN_2_BCD(x)    ((x) + 6 * ((x) / 10))
+
+// -----------------------------------------------------------------------------
+//                               Typedefs
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    // read len registers from reg of the chip at 7-bit address addr
+    esp_err_t (*read)(void *ctx, uint8_t addr, uint8_t reg,
+                      uint8_t *data, size_t len);
+    // write len registers from reg of the chip at 7-bit address addr
+    esp_err_t (*write)(void *ctx, uint8_t addr, uint8_t reg,
+                       const uint8_t *data, size_t len);
+    void *ctx;
+} rtc_bus_t; /* register access, I2C or a register-level simulator */
+
+typedef struct {
+    uint8_t second;     /* 0 to 59 or RTC_ALARM_ANY */
+    uint8_t minute;     /* 0 to 59 or RTC_ALARM_ANY */
+    uint8_t hour;       /* 0 to 23 or RTC_ALARM_ANY */
+    uint8_t date;       /* 1 to 31 or RTC_ALARM_ANY */
+} rtc_alarm_t; /* alarm matching the current time field by field */
+
+typedef struct rtc_dev rtc_dev_t;
+
+typedef struct {
+    const char *name;
+    uint8_t address;            /* 7-bit I2C address */
+    uint8_t reg_count;          /* registers 0 to reg_count - 1 */
+    uint16_t year_max;          /* last year the chip counts correctly */
+    esp_err_t (*get_time)(const rtc_dev_t *dev, date_time_t *dt);
+    esp_err_t (*set_time)(const rtc_dev_t *dev, const date_time_t *dt);
+    // the operations below are NULL when the chip does not have them
+    esp_err_t (*set_alarm)(const rtc_dev_t *dev, const rtc_alarm_t *alarm);
+    esp_err_t (*disable_alarm)(const rtc_dev_t *dev);
+    esp_err_t (*check_alarm)(const rtc_dev_t *dev, bool *fired);
+    esp_err_t (*get_temperature)(const rtc_dev_t *dev, int16_t *temp);
+} rtc_ops_t; /* operations of one RTC chip */
+
+struct rtc_dev {
+    const rtc_ops_t *ops;
+    rtc_bus_t bus;
+}; /* one RTC chip on a bus */
+
+// -----------------------------------------------------------------------------
+//                               Backends
+// -----------------------------------------------------------------------------
+
+extern const rtc_ops_t rtc_backend_ds1307;  /* time, 56 bytes of RAM */
+extern const rtc_ops_t rtc_backend_ds3231;  /* time, alarm, temperature */
+extern const rtc_ops_t rtc_backend_pcf8563; /* time, alarm (minutes) */
+
+// -----------------------------------------------------------------------------
+//                               Public functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ * @brief
+ *  Make a bus on an I2C port configured by the application. Every transfer
+ *  is a single transaction.
+ *
+ * @param[in] i2c_num
+ *  The I2C NUM to use.
+ * @param[out] bus
+ *  The bus.
+ *
+ ******************************************************************************/
+void rtc_bus_i2c(i2c_port_t i2c_num, rtc_bus_t *bus);
+
+/***************************************************************************//**
+ * @brief
+ *  Initialize an RTC. The application selects the chip once with its
+ *  backend and then uses the functions below whatever the chip.
+ *
+ * @param[out] dev
+ *  The RTC.
+ * @param[in] ops
+ *  The backend, e.g. &rtc_backend_ds3231.
+ * @param[in] bus
+ *  The bus the chip is on, copied.
+ *
+ ******************************************************************************/
+void rtc_init(rtc_dev_t *dev, const rtc_ops_t *ops, const rtc_bus_t *bus);
+
+/***************************************************************************//**
+ * @brief
+ *  Get date and time, in 24-hour format whatever mode the chip is in.
+ *  day_of_week is computed from the date, 0 for Sunday.
+ *
+ * @param[in] dev
+ *  The RTC.
+ * @param[out] dt
+ *  The date and time.
+ *
+ * @retval ESP_OK                Success
+ * @retval ESP_ERR_INVALID_STATE The oscillator stopped since the time was
+ *                               set, dt is filled but not trustworthy
+ * @retval ESP_FAIL              Fail
+ ******************************************************************************/
+esp_err_t rtc_get_time(const rtc_dev_t *dev, date_time_t *dt);
+
+/***************************************************************************//**
+ * @brief
+ *  Set date and time, and start the oscillator. day_of_week is ignored.
+ *
+ * @param[in] dev
+ *  The RTC.
+ * @param[in] dt
+ *  The date and time, year 2000 to the year_max of the backend. Every
+ *  chip takes year 00 for a leap year, so 2100 would get a February 29.
+ *
+ * @retval ESP_OK              Success
+ * @retval ESP_ERR_INVALID_ARG The date or time is out of range
+ * @retval ESP_FAIL            Fail
+ ******************************************************************************/
+esp_err_t rtc_set_time(const rtc_dev_t *dev, const date_time_t *dt);
+
+/***************************************************************************//**
+ * @brief
+ *  Read consecutive registers in one transaction.
+ *
+ * @param[in] dev
+ *  The RTC.
+ * @param[in] reg
+ *  The first register.
+ * @param[out] data
+ *  The register values.
+ * @param[in] len
+ *  The number of registers, reg + len must not pass reg_count.
+ *
+ * @retval ESP_OK              Success
+ * @retval ESP_ERR_INVALID_ARG The range is empty or past the last register
+ * @retval ESP_FAIL            Fail
+ ******************************************************************************/
+esp_err_t rtc_read_registers(const rtc_dev_t *dev, uint8_t reg,
+                             uint8_t *data, size_t len);
+
+/***************************************************************************//**
+ * @brief
+ *  Write consecutive registers in one transaction.
+ *
+ * @param[in] dev
+ *  The RTC.
+ * @param[in] reg
+ *  The first register.
+ * @param[in] data
+ *  The register values.
+ * @param[in] len
+ *  The number of registers, reg + len must not pass reg_count.
+ *
+ * @retval ESP_OK              Success
+ * @retval ESP_ERR_INVALID_ARG The range is empty or past the last register
+ * @retval ESP_FAIL            Fail
+ ******************************************************************************/
+esp_err_t rtc_write_registers(const rtc_dev_t *dev, uint8_t reg,
+                              const uint8_t *data, size_t len);
+
+/***************************************************************************//**
+ * @brief
+ *  Set and enable the hardware alarm, which drives the interrupt pin of the
+ *  chip (active low, open drain) until rtc_check_alarm() clears it. The
+ *  fields given must be a run from the second up (DS3231: e.g. second and
+ *  minute, every hour); PCF8563 has no seconds and needs second 0.
+ *
+ * @param[in] dev
+ *  The RTC.
+ * @param[in] alarm
+ *  The alarm.
+ *
+ * @retval ESP_OK                Success
+ * @retval ESP_ERR_NOT_SUPPORTED The chip has no alarm, or not this match
+ * @retval ESP_ERR_INVALID_ARG   A field is out of range
+ * @retval ESP_FAIL              Fail
+ ******************************************************************************/
+esp_err_t rtc_set_alarm(const rtc_dev_t *dev, const rtc_alarm_t *alarm);
+
+/***************************************************************************//**
+ * @brief
+ *  Disable the hardware alarm and clear its flag.
+ *
+ * @param[in] dev
+ *  The RTC.
+ *
+ * @retval ESP_OK                Success
+ * @retval ESP_ERR_NOT_SUPPORTED The chip has no alarm
+ * @retval ESP_FAIL              Fail
+ ******************************************************************************/
+esp_err_t rtc_disable_alarm(const rtc_dev_t *dev);
+
+/***************************************************************************//**
+ * @brief
+ *  Check whether the alarm fired and clear its flag, which releases the
+ *  interrupt pin. The alarm stays enabled.
+ *
+ * @param[in] dev
+ *  The RTC.
+ * @param[out] fired
+ *  The alarm fired since the last check.
+ *
+ * @retval ESP_OK                Success
+ * @retval ESP_ERR_NOT_SUPPORTED The chip has no alarm
+ * @retval ESP_FAIL              Fail
+ ******************************************************************************/
+esp_err_t rtc_check_alarm(const rtc_dev_t *dev, bool *fired);
+
+/***************************************************************************//**
+ * @brief
+ *  Get the temperature of the chip, e.g. the one DS3231 compensates its
+ *  crystal with (0.25 C steps, updated every 64 s).
+ *
+ * @param[in] dev
+ *  The RTC.
+ * @param[out] temp
+ *  The temperature in hundredths of a degree Celsius.
+ *
+ * @retval ESP_OK                Success
+ * @retval ESP_ERR_NOT_SUPPORTED The chip has no sensor
+ * @retval ESP_FAIL              Fail
+ ******************************************************************************/
+esp_err_t rtc_get_temperature(const rtc_dev_t *dev, int16_t *temp);
+
+#endif /* _RTC_H_ */
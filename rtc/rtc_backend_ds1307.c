@@ -0,0 +1,79 @@
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include "rtc.h"
+
+// -----------------------------------------------------------------------------
+//                               Macros
+// -----------------------------------------------------------------------------
+
+#define DEV_ADDR            0x68
+#define REG_SECONDS         0x00
+#define REG_COUNT           0x40
+#define SECONDS_CH          0x80    // clock halt
+#define HOUR_12H            0x40
+#define HOUR_PM             0x20
+
+// -----------------------------------------------------------------------------
+//                               Local functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Get date and time from DS1307.
+ ******************************************************************************/
+static esp_err_t rtc_ds1307_get_time(const rtc_dev_t *dev, date_time_t *dt)
+{
+    uint8_t regs[7];
+    esp_err_t status = rtc_read_registers(dev, REG_SECONDS, regs, 7);
+
+    if(status != ESP_OK) {
+        return status;
+    }
+    dt->second = RTC_BCD_2_BIN(regs[0] & 0x7F);
+    dt->minute = RTC_BCD_2_BIN(regs[1] & 0x7F);
+    if(regs[2] & HOUR_12H) {
+        dt->hour = RTC_BCD_2_BIN(regs[2] & 0x1F) % 12
+                   + ((regs[2] & HOUR_PM) ? 12 : 0);
+    } else {
+        dt->hour = RTC_BCD_2_BIN(regs[2] & 0x3F);
+    }
+    dt->date = RTC_BCD_2_BIN(regs[4] & 0x3F);
+    dt->month = RTC_BCD_2_BIN(regs[5] & 0x1F);
+    dt->year = RTC_BCD_2_BIN(regs[6]) + 2000U;
+
+    return (regs[0] & SECONDS_CH) ? ESP_ERR_INVALID_STATE : ESP_OK;
+}
+
+/***************************************************************************//**
+ *  Set date and time for DS1307, 24-hour mode, oscillator running.
+ ******************************************************************************/
+static esp_err_t rtc_ds1307_set_time(const rtc_dev_t *dev,
+                                     const date_time_t *dt)
+{
+    uint8_t regs[7] = {
+        RTC_BIN_2_BCD(dt->second),
+        RTC_BIN_2_BCD(dt->minute),
+        RTC_BIN_2_BCD(dt->hour),
+        // 1 to 7 as the chip counts, 1 is Sunday
+        rtc_day_of_week(dt->year, dt->month, dt->date) + 1,
+        RTC_BIN_2_BCD(dt->date),
+        RTC_BIN_2_BCD(dt->month),
+        RTC_BIN_2_BCD(dt->year - 2000),
+    };
+
+    return rtc_write_registers(dev, REG_SECONDS, regs, 7);
+}
+
+// -----------------------------------------------------------------------------
+//                               Backend
+// -----------------------------------------------------------------------------
+
+const rtc_ops_t rtc_backend_ds1307 = {
+    .name = "DS1307",
+    .address = DEV_ADDR,
+    .reg_count = REG_COUNT,
+    .year_max = 2099,
+    .get_time = rtc_ds1307_get_time,
+    .set_time = rtc_ds1307_set_time,
+};
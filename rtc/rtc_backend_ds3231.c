@@ -0,0 +1,205 @@
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include "rtc.h"
+
+// -----------------------------------------------------------------------------
+//                               Macros
+// -----------------------------------------------------------------------------
+
+#define DEV_ADDR            0x68
+#define REG_SECONDS         0x00
+#define REG_ALARM1          0x07
+#define REG_CONTROL         0x0E
+#define REG_STATUS          0x0F
+#define REG_TEMP            0x11
+#define REG_COUNT           0x13
+#define HOUR_12H            0x40
+#define HOUR_PM             0x20
+#define MONTH_CENTURY       0x80
+#define ALARM_MASK          0x80    // AxMy, field ignored
+#define CONTROL_INTCN       0x04    // INT/SQW pin driven by the alarms
+#define CONTROL_A1IE        0x01
+#define STATUS_OSF          0x80    // oscillator stopped
+#define STATUS_A1F          0x01
+
+// -----------------------------------------------------------------------------
+//                               Local functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Change bits of a register.
+ ******************************************************************************/
+static esp_err_t rtc_ds3231_update(const rtc_dev_t *dev, uint8_t reg,
+                                   uint8_t clear, uint8_t set)
+{
+    uint8_t value;
+    esp_err_t status = rtc_read_registers(dev, reg, &value, 1);
+
+    if(status != ESP_OK) {
+        return status;
+    }
+    value = (value & ~clear) | set;
+    return rtc_write_registers(dev, reg, &value, 1);
+}
+
+/***************************************************************************//**
+ *  Get date and time from DS3231.
+ ******************************************************************************/
+static esp_err_t rtc_ds3231_get_time(const rtc_dev_t *dev, date_time_t *dt)
+{
+    uint8_t regs[7], flags;
+    esp_err_t status = rtc_read_registers(dev, REG_SECONDS, regs, 7);
+
+    if(status == ESP_OK) {
+        status = rtc_read_registers(dev, REG_STATUS, &flags, 1);
+    }
+    if(status != ESP_OK) {
+        return status;
+    }
+    dt->second = RTC_BCD_2_BIN(regs[0] & 0x7F);
+    dt->minute = RTC_BCD_2_BIN(regs[1] & 0x7F);
+    if(regs[2] & HOUR_12H) {
+        dt->hour = RTC_BCD_2_BIN(regs[2] & 0x1F) % 12
+                   + ((regs[2] & HOUR_PM) ? 12 : 0);
+    } else {
+        dt->hour = RTC_BCD_2_BIN(regs[2] & 0x3F);
+    }
+    dt->date = RTC_BCD_2_BIN(regs[4] & 0x3F);
+    dt->month = RTC_BCD_2_BIN(regs[5] & 0x1F);
+    // The century bit is set when the year rolls over from 99
+    dt->year = RTC_BCD_2_BIN(regs[6]) + 2000U
+               + ((regs[5] & MONTH_CENTURY) ? 100 : 0);
+
+    return (flags & STATUS_OSF) ? ESP_ERR_INVALID_STATE : ESP_OK;
+}
+
+/***************************************************************************//**
+ *  Set date and time for DS3231, 24-hour mode, and clear the stop flag.
+ ******************************************************************************/
+static esp_err_t rtc_ds3231_set_time(const rtc_dev_t *dev,
+                                     const date_time_t *dt)
+{
+    uint8_t regs[7] = {
+        RTC_BIN_2_BCD(dt->second),
+        RTC_BIN_2_BCD(dt->minute),
+        RTC_BIN_2_BCD(dt->hour),
+        // 1 to 7 as the chip counts, 1 is Sunday
+        rtc_day_of_week(dt->year, dt->month, dt->date) + 1,
+        RTC_BIN_2_BCD(dt->date),
+        RTC_BIN_2_BCD(dt->month),
+        RTC_BIN_2_BCD(dt->year % 100),
+    };
+    esp_err_t status = rtc_write_registers(dev, REG_SECONDS, regs, 7);
+
+    if(status != ESP_OK) {
+        return status;
+    }
+    return rtc_ds3231_update(dev, REG_STATUS, STATUS_OSF, 0);
+}
+
+/***************************************************************************//**
+ *  Set and enable alarm 1 of DS3231.
+ ******************************************************************************/
+static esp_err_t rtc_ds3231_set_alarm(const rtc_dev_t *dev,
+                                      const rtc_alarm_t *alarm)
+{
+    const uint8_t fields[4] = {
+        alarm->second, alarm->minute, alarm->hour, alarm->date
+    };
+    uint8_t regs[4];
+    bool any = false;
+    esp_err_t status;
+
+    // The chip matches the second, then up to minute, hour and date
+    for(uint8_t i = 0; i < 4; i++) {
+        if(fields[i] == RTC_ALARM_ANY) {
+            any = true;
+            regs[i] = ALARM_MASK;
+        } else if(any) {
+            return ESP_ERR_NOT_SUPPORTED;
+        } else {
+            regs[i] = RTC_BIN_2_BCD(fields[i]);
+        }
+    }
+
+    status = rtc_ds3231_update(dev, REG_CONTROL, CONTROL_A1IE, 0);
+    if(status == ESP_OK) {
+        status = rtc_write_registers(dev, REG_ALARM1, regs, 4);
+    }
+    if(status == ESP_OK) {
+        status = rtc_ds3231_update(dev, REG_STATUS, STATUS_A1F, 0);
+    }
+    if(status == ESP_OK) {
+        status = rtc_ds3231_update(dev, REG_CONTROL, 0,
+                                   CONTROL_INTCN | CONTROL_A1IE);
+    }
+    return status;
+}
+
+/***************************************************************************//**
+ *  Disable alarm 1 of DS3231.
+ ******************************************************************************/
+static esp_err_t rtc_ds3231_disable_alarm(const rtc_dev_t *dev)
+{
+    esp_err_t status = rtc_ds3231_update(dev, REG_CONTROL, CONTROL_A1IE, 0);
+
+    if(status != ESP_OK) {
+        return status;
+    }
+    return rtc_ds3231_update(dev, REG_STATUS, STATUS_A1F, 0);
+}
+
+/***************************************************************************//**
+ *  Check and clear the alarm 1 flag of DS3231.
+ ******************************************************************************/
+static esp_err_t rtc_ds3231_check_alarm(const rtc_dev_t *dev, bool *fired)
+{
+    uint8_t flags;
+    esp_err_t status = rtc_read_registers(dev, REG_STATUS, &flags, 1);
+
+    if(status != ESP_OK) {
+        return status;
+    }
+    *fired = (flags & STATUS_A1F) != 0;
+    if(*fired) {
+        flags &= ~STATUS_A1F;
+        status = rtc_write_registers(dev, REG_STATUS, &flags, 1);
+    }
+    return status;
+}
+
+/***************************************************************************//**
+ *  Get the temperature of DS3231.
+ ******************************************************************************/
+static esp_err_t rtc_ds3231_get_temperature(const rtc_dev_t *dev,
+                                            int16_t *temp)
+{
+    uint8_t regs[2];
+    esp_err_t status = rtc_read_registers(dev, REG_TEMP, regs, 2);
+
+    if(status != ESP_OK) {
+        return status;
+    }
+    // Signed integer part, then quarters of a degree in bits 7:6
+    *temp = (int8_t)regs[0] * 100 + (regs[1] >> 6) * 25;
+    return ESP_OK;
+}
+
+// -----------------------------------------------------------------------------
+//                               Backend
+// -----------------------------------------------------------------------------
+
+const rtc_ops_t rtc_backend_ds3231 = {
+    .name = "DS3231",
+    .address = DEV_ADDR,
+    .reg_count = REG_COUNT,
+    .year_max = 2099,
+    .get_time = rtc_ds3231_get_time,
+    .set_time = rtc_ds3231_set_time,
+    .set_alarm = rtc_ds3231_set_alarm,
+    .disable_alarm = rtc_ds3231_disable_alarm,
+    .check_alarm = rtc_ds3231_check_alarm,
+    .get_temperature = rtc_ds3231_get_temperature,
+};
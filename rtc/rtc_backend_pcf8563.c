@@ -0,0 +1,167 @@
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include "rtc.h"
+
+// -----------------------------------------------------------------------------
+//                               Macros
+// -----------------------------------------------------------------------------
+
+#define DEV_ADDR            0x51
+#define REG_CONTROL2        0x01
+#define REG_SECONDS         0x02
+#define REG_ALARM           0x09
+#define REG_COUNT           0x10
+#define SECONDS_VL          0x80    // voltage low, time not guaranteed
+#define MONTH_CENTURY       0x80
+#define ALARM_DISABLE       0x80    // AE_x, field ignored
+#define CONTROL2_MASK       0x1F    // bits 7:5 must be written 0
+#define CONTROL2_AF         0x08
+#define CONTROL2_AIE        0x02
+
+// -----------------------------------------------------------------------------
+//                               Local functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Change bits of control register 2. Writing 1 to a flag keeps it as is,
+ *  so only the flags in clear are cleared.
+ ******************************************************************************/
+static esp_err_t rtc_pcf8563_update_control2(const rtc_dev_t *dev,
+                                             uint8_t clear, uint8_t set)
+{
+    uint8_t value;
+    esp_err_t status = rtc_read_registers(dev, REG_CONTROL2, &value, 1);
+
+    if(status != ESP_OK) {
+        return status;
+    }
+    value = ((value & ~clear) | set) & CONTROL2_MASK;
+    return rtc_write_registers(dev, REG_CONTROL2, &value, 1);
+}
+
+/***************************************************************************//**
+ *  Get date and time from PCF8563.
+ ******************************************************************************/
+static esp_err_t rtc_pcf8563_get_time(const rtc_dev_t *dev, date_time_t *dt)
+{
+    uint8_t regs[7];
+    esp_err_t status = rtc_read_registers(dev, REG_SECONDS, regs, 7);
+
+    if(status != ESP_OK) {
+        return status;
+    }
+    // Seconds, minutes, hours, days, weekdays, months, years
+    dt->second = RTC_BCD_2_BIN(regs[0] & 0x7F);
+    dt->minute = RTC_BCD_2_BIN(regs[1] & 0x7F);
+    dt->hour = RTC_BCD_2_BIN(regs[2] & 0x3F);
+    dt->date = RTC_BCD_2_BIN(regs[3] & 0x3F);
+    dt->month = RTC_BCD_2_BIN(regs[5] & 0x1F);
+    // The century bit is set when the year rolls over from 99
+    dt->year = RTC_BCD_2_BIN(regs[6]) + 2000U
+               + ((regs[5] & MONTH_CENTURY) ? 100 : 0);
+
+    return (regs[0] & SECONDS_VL) ? ESP_ERR_INVALID_STATE : ESP_OK;
+}
+
+/***************************************************************************//**
+ *  Set date and time for PCF8563, which clears the voltage low flag.
+ ******************************************************************************/
+static esp_err_t rtc_pcf8563_set_time(const rtc_dev_t *dev,
+                                      const date_time_t *dt)
+{
+    uint8_t regs[7] = {
+        RTC_BIN_2_BCD(dt->second),
+        RTC_BIN_2_BCD(dt->minute),
+        RTC_BIN_2_BCD(dt->hour),
+        RTC_BIN_2_BCD(dt->date),
+        rtc_day_of_week(dt->year, dt->month, dt->date),
+        RTC_BIN_2_BCD(dt->month),
+        RTC_BIN_2_BCD(dt->year % 100),
+    };
+
+    return rtc_write_registers(dev, REG_SECONDS, regs, 7);
+}
+
+/***************************************************************************//**
+ *  Set and enable the alarm of PCF8563.
+ ******************************************************************************/
+static esp_err_t rtc_pcf8563_set_alarm(const rtc_dev_t *dev,
+                                       const rtc_alarm_t *alarm)
+{
+    const uint8_t fields[3] = {alarm->minute, alarm->hour, alarm->date};
+    uint8_t regs[4];
+    bool any_set = false;
+    esp_err_t status;
+
+    // No seconds, the alarm fires at the start of the matching minute
+    if(alarm->second != 0) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    for(uint8_t i = 0; i < 3; i++) {
+        if(fields[i] == RTC_ALARM_ANY) {
+            regs[i] = ALARM_DISABLE;
+        } else {
+            regs[i] = RTC_BIN_2_BCD(fields[i]);
+            any_set = true;
+        }
+    }
+    regs[3] = ALARM_DISABLE;    // weekday
+    // With every field ignored the chip never fires
+    if(!any_set) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    status = rtc_pcf8563_update_control2(dev, CONTROL2_AIE, 0);
+    if(status == ESP_OK) {
+        status = rtc_write_registers(dev, REG_ALARM, regs, 4);
+    }
+    if(status == ESP_OK) {
+        status = rtc_pcf8563_update_control2(dev, CONTROL2_AF, CONTROL2_AIE);
+    }
+    return status;
+}
+
+/***************************************************************************//**
+ *  Disable the alarm of PCF8563.
+ ******************************************************************************/
+static esp_err_t rtc_pcf8563_disable_alarm(const rtc_dev_t *dev)
+{
+    return rtc_pcf8563_update_control2(dev, CONTROL2_AIE | CONTROL2_AF, 0);
+}
+
+/***************************************************************************//**
+ *  Check and clear the alarm flag of PCF8563.
+ ******************************************************************************/
+static esp_err_t rtc_pcf8563_check_alarm(const rtc_dev_t *dev, bool *fired)
+{
+    uint8_t control2;
+    esp_err_t status = rtc_read_registers(dev, REG_CONTROL2, &control2, 1);
+
+    if(status != ESP_OK) {
+        return status;
+    }
+    *fired = (control2 & CONTROL2_AF) != 0;
+    if(*fired) {
+        control2 = control2 & ~CONTROL2_AF & CONTROL2_MASK;
+        status = rtc_write_registers(dev, REG_CONTROL2, &control2, 1);
+    }
+    return status;
+}
+
+// -----------------------------------------------------------------------------
+//                               Backend
+// -----------------------------------------------------------------------------
+
+const rtc_ops_t rtc_backend_pcf8563 = {
+    .name = "PCF8563",
+    .address = DEV_ADDR,
+    .reg_count = REG_COUNT,
+    .year_max = 2099,
+    .get_time = rtc_pcf8563_get_time,
+    .set_time = rtc_pcf8563_set_time,
+    .set_alarm = rtc_pcf8563_set_alarm,
+    .disable_alarm = rtc_pcf8563_disable_alarm,
+    .check_alarm = rtc_pcf8563_check_alarm,
+};
@@ -0,0 +1,87 @@
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include "rtc_time.h"
+
+// -----------------------------------------------------------------------------
+//                               Local functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Days since 1970-01-01 of a proleptic Gregorian date, in constant time.
+ *  The year is counted from March so the leap day is the last of the year.
+ ******************************************************************************/
+static int32_t rtc_days_from_civil(int32_t year, uint8_t month, uint8_t date)
+{
+    int32_t era, yoe, doy, doe;
+
+    year -= (month <= 2);
+    era = ((year >= 0) ? year : year - 399) / 400;
+    yoe = year - era * 400;                                 // [0, 399]
+    doy = (153 * (month + ((month > 2) ? -3 : 9)) + 2) / 5 + date - 1;
+    doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;            // [0, 146096]
+    return era * 146097 + doe - 719468;
+}
+
+/***************************************************************************//**
+ *  Proleptic Gregorian date of a number of days since 1970-01-01, in
+ *  constant time.
+ ******************************************************************************/
+static void rtc_civil_from_days(int32_t days, date_time_t *dt)
+{
+    int32_t era, doe, yoe, doy, mp;
+
+    days += 719468;
+    era = ((days >= 0) ? days : days - 146096) / 146097;
+    doe = days - era * 146097;                              // [0, 146096]
+    yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    doy = doe - (365 * yoe + yoe / 4 - yoe / 100);          // [0, 365]
+    mp = (5 * doy + 2) / 153;                               // [0, 11]
+    dt->date = doy - (153 * mp + 2) / 5 + 1;
+    dt->month = (mp < 10) ? mp + 3 : mp - 9;
+    dt->year = yoe + era * 400 + (dt->month <= 2);
+}
+
+// -----------------------------------------------------------------------------
+//                               Public functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Day of the week, 0 is Sunday.
+ ******************************************************************************/
+uint8_t rtc_day_of_week(uint16_t year, uint8_t month, uint8_t date)
+{
+    // 1970-01-01 was a Thursday
+    return (rtc_days_from_civil(year, month, date) % 7 + 11) % 7;
+}
+
+/***************************************************************************//**
+ *  Convert a date and time to Unix time.
+ ******************************************************************************/
+time_t rtc_date_time_to_epoch(const date_time_t *dt)
+{
+    int32_t days = rtc_days_from_civil(dt->year, dt->month, dt->date);
+
+    return (time_t)days * 86400
+           + dt->hour * 3600 + dt->minute * 60 + dt->second;
+}
+
+/***************************************************************************//**
+ *  Convert Unix time to a date and time.
+ ******************************************************************************/
+void rtc_epoch_to_date_time(time_t epoch, date_time_t *dt)
+{
+    int32_t days = epoch / 86400;
+    int32_t seconds = epoch % 86400;
+
+    if(seconds < 0) {
+        seconds += 86400;
+        days--;
+    }
+    rtc_civil_from_days(days, dt);
+    dt->day_of_week = (days % 7 + 11) % 7;   // 1970-01-01 was a Thursday
+    dt->hour = seconds / 3600;
+    dt->minute = (seconds / 60) % 60;
+    dt->second = seconds % 60;
+}
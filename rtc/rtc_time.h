@@ -0,0 +1,70 @@
+#ifndef _RTC_TIME_H_
+#define _RTC_TIME_H_
+
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <time.h>
+
+// -----------------------------------------------------------------------------
+//                               Typedefs
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    uint16_t year;
+    uint8_t month;
+    uint8_t date;
+    uint8_t day_of_week;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+} date_time_t; /* struct to hold the date time value */
+
+// -----------------------------------------------------------------------------
+//                               Public functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ * @brief
+ *  Get the day of the week of a proleptic Gregorian date, in constant time.
+ *
+ * @param[in] year
+ *  The year.
+ * @param[in] month
+ *  The month, 1 to 12.
+ * @param[in] date
+ *  The day of the month.
+ *
+ * @return
+ *  The day of the week, 0 for Sunday.
+ ******************************************************************************/
+uint8_t rtc_day_of_week(uint16_t year, uint8_t month, uint8_t date);
+
+/***************************************************************************//**
+ * @brief
+ *  Convert a date and time to Unix time, UTC, without libc time zone state.
+ *  Constant time, no loops over months or years. day_of_week is ignored.
+ *
+ * @param[in] dt
+ *  The date and time, any valid proleptic Gregorian date.
+ *
+ * @return
+ *  The seconds since 1970-01-01 00:00:00.
+ ******************************************************************************/
+time_t rtc_date_time_to_epoch(const date_time_t *dt);
+
+/***************************************************************************//**
+ * @brief
+ *  Convert Unix time, UTC, to a date and time without libc time zone state.
+ *  Constant time, day_of_week is filled with 0 for Sunday.
+ *
+ * @param[in] epoch
+ *  The seconds since 1970-01-01 00:00:00.
+ * @param[out] dt
+ *  The date and time.
+ ******************************************************************************/
+void rtc_epoch_to_date_time(time_t epoch, date_time_t *dt);
+
+#endif /* _RTC_TIME_H_ */
@@ -2,85 +2,76 @@
 //                               Includes
 // -----------------------------------------------------------------------------
 
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
+#include "rtc.h"
 #include "rtc_ds1307.h"
 
 // -----------------------------------------------------------------------------
 //                               Macros
 // -----------------------------------------------------------------------------
 
-#define DEV_ADDR            0x68
-#define ACK_EN              0x01
-#define ACK_DIS             0x00
-
-// convert BCD format to Binary format
-#define BCD_2_BIN(x)        ((x) - 6 * ((x) >> 4))
-// convert Binary format to BCD format
-#define BIN_2_BCD(x)        ((x) + 6 * ((x) / 10))
+#define REG_CONTROL         0x07
+#define REG_NVRAM           0x08
 
 // -----------------------------------------------------------------------------
 //                               Local variables
 // -----------------------------------------------------------------------------
 
-static i2c_port_t rtc_ds1307_i2c_port;
-const uint8_t days_in_month[11] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30};
+static rtc_dev_t rtc_ds1307_dev;
+
 // -----------------------------------------------------------------------------
-//                               Local functions
+//                               Public functions
 // -----------------------------------------------------------------------------
 
 /***************************************************************************//**
- *  Send data to RTC DS1307.
+ *  DS1307 Initialization.
  ******************************************************************************/
-static esp_err_t rtc_ds1307_i2c_send_data(uint8_t *data, uint8_t len)
+void rtc_ds1307_init(i2c_port_t i2c_num)
 {
-    esp_err_t status;
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-
-    ESP_ERROR_CHECK(i2c_master_start(cmd));
-    ESP_ERROR_CHECK(i2c_master_write_byte(cmd,
-                                         (DEV_ADDR << 1) | I2C_MASTER_WRITE,
-                                          ACK_EN));
-    ESP_ERROR_CHECK(i2c_master_write(cmd, data, len, ACK_EN));
-    ESP_ERROR_CHECK(i2c_master_stop(cmd));
-    status = i2c_master_cmd_begin(rtc_ds1307_i2c_port,
-                                  cmd,
-                                  pdMS_TO_TICKS(1000));
-    i2c_cmd_link_delete(cmd);
-
-    return status;
+    rtc_bus_t bus;
+
+    rtc_bus_i2c(i2c_num, &bus);
+    rtc_init(&rtc_ds1307_dev, &rtc_backend_ds1307, &bus);
 }
 
 /***************************************************************************//**
- *  Get day of the week function.
+ *  Read consecutive registers of RTC DS1307.
  ******************************************************************************/
-static uint8_t rtc_ds1307_get_day_of_week(uint16_t year,
-                                          uint8_t month,
-                                          uint8_t date)
+esp_err_t rtc_ds1307_read_registers(uint8_t reg, uint8_t *data, size_t len)
 {
-    if(year >= 2000U) {
-        year -= 2000U;
-    }
-    uint16_t days = date;
-    for(uint8_t i = 1; i < month; ++i) {
-        days += *(const unsigned char *)(days_in_month + i - 1);
-    }
-    if ((month > 2) && ((year % 4) == 0)) {
-        ++days;
-    }
-    return (days + 365 * year + (year + 3) / 4 - 1 + 6) % 7;
+    return rtc_read_registers(&rtc_ds1307_dev, reg, data, len);
 }
 
-// -----------------------------------------------------------------------------
-//                               Public functions
-// -----------------------------------------------------------------------------
+/***************************************************************************//**
+ *  Write consecutive registers of RTC DS1307.
+ ******************************************************************************/
+esp_err_t rtc_ds1307_write_registers(uint8_t reg, const uint8_t *data,
+                                     size_t len)
+{
+    return rtc_write_registers(&rtc_ds1307_dev, reg, data, len);
+}
 
 /***************************************************************************//**
- *  DS1307 Initialization.
+ *  Read the battery-backed RAM of RTC DS1307.
  ******************************************************************************/
-void rtc_ds1307_init(i2c_port_t i2c_num)
+esp_err_t rtc_ds1307_nvram_read(uint8_t offset, void *data, size_t len)
 {
-    rtc_ds1307_i2c_port = i2c_num;
+    if((offset >= RTC_DS1307_NVRAM_SIZE)
+       || (len > RTC_DS1307_NVRAM_SIZE - offset)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return rtc_ds1307_read_registers(REG_NVRAM + offset, data, len);
+}
+
+/***************************************************************************//**
+ *  Write the battery-backed RAM of RTC DS1307.
+ ******************************************************************************/
+esp_err_t rtc_ds1307_nvram_write(uint8_t offset, const void *data, size_t len)
+{
+    if((offset >= RTC_DS1307_NVRAM_SIZE)
+       || (len > RTC_DS1307_NVRAM_SIZE - offset)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return rtc_ds1307_write_registers(REG_NVRAM + offset, data, len);
 }
 
 /***************************************************************************//**
@@ -89,17 +80,16 @@ void rtc_ds1307_init(i2c_port_t i2c_num)
 esp_err_t rtc_ds1307_set_date_time(uint16_t year, uint8_t month, uint8_t date,
                                    uint8_t hour, uint8_t minute, uint8_t second)
 {
-    uint8_t buffer[8] = {
-        0,
-        BIN_2_BCD(second),
-        BIN_2_BCD(minute),
-        BIN_2_BCD(hour),
-        BIN_2_BCD(rtc_ds1307_get_day_of_week(year, month, date)),
-        BIN_2_BCD(date),
-        BIN_2_BCD(month),
-        BIN_2_BCD((year - 2000)),
+    const date_time_t dt = {
+        .year = year,
+        .month = month,
+        .date = date,
+        .hour = hour,
+        .minute = minute,
+        .second = second,
     };
-    return rtc_ds1307_i2c_send_data(buffer, 8);
+
+    return rtc_set_time(&rtc_ds1307_dev, &dt);
 }
 
 /***************************************************************************//**
@@ -107,37 +97,31 @@ esp_err_t rtc_ds1307_set_date_time(uint16_t year, uint8_t month, uint8_t date,
  ******************************************************************************/
 esp_err_t rtc_ds1307_get_current_date_time(date_time_t *dt)
 {
-    esp_err_t status;
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    uint8_t recv_data[7];
-
-    ESP_ERROR_CHECK(i2c_master_start(cmd));
-    ESP_ERROR_CHECK(i2c_master_write_byte(cmd,
-                                          (DEV_ADDR << 1) | I2C_MASTER_WRITE,
-                                          ACK_EN));
-    ESP_ERROR_CHECK(i2c_master_write_byte(cmd, 0x00, ACK_EN));
-
-    // Repeat start
-    ESP_ERROR_CHECK(i2c_master_start(cmd));
-    ESP_ERROR_CHECK(i2c_master_write_byte(cmd,
-                                          (DEV_ADDR << 1) | I2C_MASTER_READ,
-                                          ACK_EN));
-    ESP_ERROR_CHECK(i2c_master_read(cmd, recv_data, 6, I2C_MASTER_ACK));
-    ESP_ERROR_CHECK(i2c_master_read(cmd, recv_data + 6, 1, I2C_MASTER_NACK));
-    ESP_ERROR_CHECK(i2c_master_stop(cmd));
-
-    status = i2c_master_cmd_begin(rtc_ds1307_i2c_port,
-                                  cmd,
-                                  pdMS_TO_TICKS(1000));
-    i2c_cmd_link_delete(cmd);
-
-    dt->year = BCD_2_BIN(recv_data[6]) + 2000U;
-    dt->month = BCD_2_BIN(recv_data[5]);
-    dt->date = BCD_2_BIN(recv_data[4]);
-    dt->day_of_week = BCD_2_BIN(recv_data[3]);
-    dt->hour = BCD_2_BIN(recv_data[2]);
-    dt->minute = BCD_2_BIN(recv_data[1]);
-    dt->second = BCD_2_BIN(recv_data[0]);
-
-    return status;
-}
\ No newline at end of file
+    return rtc_get_time(&rtc_ds1307_dev, dt);
+}
+
+/***************************************************************************//**
+ *  Set the SQW/OUT pin of RTC DS1307.
+ ******************************************************************************/
+esp_err_t rtc_ds1307_set_sqw(rtc_ds1307_sqw_t mode)
+{
+    uint8_t control = mode;
+
+    return rtc_ds1307_write_registers(REG_CONTROL, &control, 1);
+}
+
+/***************************************************************************//**
+ *  Convert a date and time to Unix time.
+ ******************************************************************************/
+time_t rtc_ds1307_date_time_to_epoch(const date_time_t *dt)
+{
+    return rtc_date_time_to_epoch(dt);
+}
+
+/***************************************************************************//**
+ *  Convert Unix time to a date and time.
+ ******************************************************************************/
+void rtc_ds1307_epoch_to_date_time(time_t epoch, date_time_t *dt)
+{
+    rtc_epoch_to_date_time(epoch, dt);
+}
@@ -7,20 +7,27 @@
 
 #include "esp_err.h"
 #include "driver/i2c.h"
+#include "rtc_time.h"
+
+// -----------------------------------------------------------------------------
+//                               Macros
+// -----------------------------------------------------------------------------
+
+// battery-backed RAM, registers 0x08 to 0x3F
+#define RTC_DS1307_NVRAM_SIZE   56
 
 // -----------------------------------------------------------------------------
 //                               Typedefs
 // -----------------------------------------------------------------------------
 
-typedef struct {
-    uint16_t year;
-    uint8_t month;
-    uint8_t date;
-    uint8_t day_of_week;
-    uint8_t hour;
-    uint8_t minute;
-    uint8_t second;
-} date_time_t; /* struct to hold the date time value */
+typedef enum {
+    RTC_DS1307_SQW_OFF_LOW  = 0x00, /* output disabled, held low */
+    RTC_DS1307_SQW_OFF_HIGH = 0x80, /* output disabled, released high */
+    RTC_DS1307_SQW_1HZ      = 0x10,
+    RTC_DS1307_SQW_4KHZ     = 0x11, /* 4.096 kHz */
+    RTC_DS1307_SQW_8KHZ     = 0x12, /* 8.192 kHz */
+    RTC_DS1307_SQW_32KHZ    = 0x13, /* 32.768 kHz */
+} rtc_ds1307_sqw_t; /* control register values for the SQW/OUT pin */
 
 // -----------------------------------------------------------------------------
 //                               Public functions
@@ -28,7 +35,9 @@ typedef struct {
 
 /***************************************************************************//**
  * @brief
- *  Initialize RTC DS1307.
+ *  Initialize RTC DS1307. The driver is the rtc_backend_ds1307 backend of
+ *  the rtc component on a fixed device, so rtc/ (rtc.c,
+ *  rtc_backend_ds1307.c and rtc_time.c) must be built along with it.
  *
  * @param[in] i2c_num
  *  The I2C NUM to use for RTC DS1307.
@@ -53,8 +62,10 @@ void rtc_ds1307_init(i2c_port_t i2c_num);
  * @param[in] second
  *  The second that set to RTC DS1307.
  *
- * @retval ESP_OK   Success
- * @retval ESP_FAIL Fail
+ * @retval ESP_OK              Success
+ * @retval ESP_ERR_INVALID_ARG The date or time is out of range, the year
+ *                             must be 2000 to 2099
+ * @retval ESP_FAIL            Fail
  ******************************************************************************/
 esp_err_t rtc_ds1307_set_date_time(uint16_t year,
                                    uint8_t month,
@@ -68,11 +79,123 @@ esp_err_t rtc_ds1307_set_date_time(uint16_t year,
  *  Get date and time from RTC DS1307..
  *
  * @param[out] dt
- *  The date and time get from RTC DS1307.
+ *  The date and time get from RTC DS1307, in 24-hour format.
+ *
+ * @retval ESP_OK                Success
+ * @retval ESP_ERR_INVALID_STATE The clock is halted (CH bit set), dt is
+ *                               filled but not running
+ * @retval ESP_FAIL              Fail
+ ******************************************************************************/
+esp_err_t rtc_ds1307_get_current_date_time(date_time_t *dt);
+
+/***************************************************************************//**
+ * @brief
+ *  Set the SQW/OUT pin of RTC DS1307 (control register 0x07). SQW/OUT is
+ *  open drain and needs a pull-up. At 1 Hz the seconds register advances
+ *  on the falling edge.
+ *
+ * @param[in] mode
+ *  The square wave frequency, or the level of the disabled output.
  *
  * @retval ESP_OK   Success
  * @retval ESP_FAIL Fail
  ******************************************************************************/
-esp_err_t rtc_ds1307_get_current_date_time(date_time_t *dt);
+esp_err_t rtc_ds1307_set_sqw(rtc_ds1307_sqw_t mode);
+
+/***************************************************************************//**
+ * @brief
+ *  Read consecutive registers of RTC DS1307 in one I2C transaction. The
+ *  address pointer auto-increments, and DS1307 latches the time registers
+ *  at the start of the transaction so a burst read of them is consistent.
+ *
+ * @param[in] reg
+ *  The first register, 0x00 to 0x3F.
+ * @param[out] data
+ *  The register values.
+ * @param[in] len
+ *  The number of registers, reg + len must not pass 0x40.
+ *
+ * @retval ESP_OK              Success
+ * @retval ESP_ERR_INVALID_ARG The range is empty or past 0x3F
+ * @retval ESP_FAIL            Fail
+ ******************************************************************************/
+esp_err_t rtc_ds1307_read_registers(uint8_t reg, uint8_t *data, size_t len);
+
+/***************************************************************************//**
+ * @brief
+ *  Write consecutive registers of RTC DS1307 in one I2C transaction.
+ *
+ * @param[in] reg
+ *  The first register, 0x00 to 0x3F.
+ * @param[in] data
+ *  The register values.
+ * @param[in] len
+ *  The number of registers, reg + len must not pass 0x40.
+ *
+ * @retval ESP_OK              Success
+ * @retval ESP_ERR_INVALID_ARG The range is empty or past 0x3F
+ * @retval ESP_FAIL            Fail
+ ******************************************************************************/
+esp_err_t rtc_ds1307_write_registers(uint8_t reg, const uint8_t *data,
+                                     size_t len);
+
+/***************************************************************************//**
+ * @brief
+ *  Read the battery-backed RAM of RTC DS1307 in one I2C transaction.
+ *
+ * @param[in] offset
+ *  The first byte, 0 to RTC_DS1307_NVRAM_SIZE - 1.
+ * @param[out] data
+ *  The bytes read.
+ * @param[in] len
+ *  The number of bytes, offset + len must not pass RTC_DS1307_NVRAM_SIZE.
+ *
+ * @retval ESP_OK              Success
+ * @retval ESP_ERR_INVALID_ARG The range is empty or out of the RAM
+ * @retval ESP_FAIL            Fail
+ ******************************************************************************/
+esp_err_t rtc_ds1307_nvram_read(uint8_t offset, void *data, size_t len);
+
+/***************************************************************************//**
+ * @brief
+ *  Write the battery-backed RAM of RTC DS1307 in one I2C transaction. The
+ *  content survives power loss as long as the backup battery holds.
+ *
+ * @param[in] offset
+ *  The first byte, 0 to RTC_DS1307_NVRAM_SIZE - 1.
+ * @param[in] data
+ *  The bytes to write.
+ * @param[in] len
+ *  The number of bytes, offset + len must not pass RTC_DS1307_NVRAM_SIZE.
+ *
+ * @retval ESP_OK              Success
+ * @retval ESP_ERR_INVALID_ARG The range is empty or out of the RAM
+ * @retval ESP_FAIL            Fail
+ ******************************************************************************/
+esp_err_t rtc_ds1307_nvram_write(uint8_t offset, const void *data, size_t len);
+
+/***************************************************************************//**
+ * @brief
+ *  Convert a date and time to Unix time, UTC, see rtc_date_time_to_epoch().
+ *
+ * @param[in] dt
+ *  The date and time, any valid proleptic Gregorian date.
+ *
+ * @return
+ *  The seconds since 1970-01-01 00:00:00.
+ ******************************************************************************/
+time_t rtc_ds1307_date_time_to_epoch(const date_time_t *dt);
+
+/***************************************************************************//**
+ * @brief
+ *  Convert Unix time, UTC, to a date and time, see
+ *  rtc_epoch_to_date_time().
+ *
+ * @param[in] epoch
+ *  The seconds since 1970-01-01 00:00:00.
+ * @param[out] dt
+ *  The date and time.
+ ******************************************************************************/
+void rtc_ds1307_epoch_to_date_time(time_t epoch, date_time_t *dt);
 
 #endif /* _RTC_DS1307_H_ */
\ No newline at end of file
@@ -0,0 +1,299 @@
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <sys/time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "rtc_ds1307_alarm.h"
+
+// -----------------------------------------------------------------------------
+//                               Typedefs
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    time_t when;                    // next deadline
+    uint32_t period_s;              // 0 for one-shot
+    rtc_ds1307_alarm_cb_t callback;
+    void *arg;
+    uint16_t generation;            // bumped at each add, part of the id
+    uint8_t heap_pos;               // position in alarm_heap
+    bool used;
+} rtc_ds1307_alarm_slot_t;
+
+// -----------------------------------------------------------------------------
+//                               Local variables
+// -----------------------------------------------------------------------------
+
+static rtc_ds1307_alarm_slot_t alarm_slot[RTC_DS1307_ALARM_MAX];
+static uint8_t alarm_heap[RTC_DS1307_ALARM_MAX];    // slots, earliest first
+static uint8_t alarm_count;
+static esp_timer_handle_t alarm_timer;
+static SemaphoreHandle_t alarm_lock;
+
+// -----------------------------------------------------------------------------
+//                               Local functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Deadline of the alarm at a heap position.
+ ******************************************************************************/
+static time_t rtc_ds1307_alarm_when(uint8_t pos)
+{
+    return alarm_slot[alarm_heap[pos]].when;
+}
+
+/***************************************************************************//**
+ *  Id of the alarm in a slot. The generation makes it unique, so a stale id
+ *  does not match the next alarm that reuses the slot.
+ ******************************************************************************/
+static int rtc_ds1307_alarm_id(uint8_t slot)
+{
+    return alarm_slot[slot].generation * RTC_DS1307_ALARM_MAX + slot;
+}
+
+/***************************************************************************//**
+ *  Put a slot at a heap position.
+ ******************************************************************************/
+static void rtc_ds1307_alarm_place(uint8_t pos, uint8_t slot)
+{
+    alarm_heap[pos] = slot;
+    alarm_slot[slot].heap_pos = pos;
+}
+
+/***************************************************************************//**
+ *  Restore the heap order around a position whose deadline changed.
+ ******************************************************************************/
+static void rtc_ds1307_alarm_sift(uint8_t pos)
+{
+    uint8_t slot = alarm_heap[pos];
+    time_t when = alarm_slot[slot].when;
+
+    // Up while earlier than the parent
+    while((pos > 0) && (when < rtc_ds1307_alarm_when((pos - 1) / 2))) {
+        rtc_ds1307_alarm_place(pos, alarm_heap[(pos - 1) / 2]);
+        pos = (pos - 1) / 2;
+    }
+    // Down while later than the earliest child
+    for(;;) {
+        uint8_t child = 2 * pos + 1;
+        if(child >= alarm_count) {
+            break;
+        }
+        if((child + 1 < alarm_count)
+           && (rtc_ds1307_alarm_when(child + 1)
+               < rtc_ds1307_alarm_when(child))) {
+            child++;
+        }
+        if(rtc_ds1307_alarm_when(child) >= when) {
+            break;
+        }
+        rtc_ds1307_alarm_place(pos, alarm_heap[child]);
+        pos = child;
+    }
+    rtc_ds1307_alarm_place(pos, slot);
+}
+
+/***************************************************************************//**
+ *  Take a slot out of the heap and free it.
+ ******************************************************************************/
+static void rtc_ds1307_alarm_remove(uint8_t slot)
+{
+    uint8_t pos = alarm_slot[slot].heap_pos;
+
+    alarm_slot[slot].used = false;
+    if(pos != --alarm_count) {
+        rtc_ds1307_alarm_place(pos, alarm_heap[alarm_count]);
+        rtc_ds1307_alarm_sift(pos);
+    }
+}
+
+/***************************************************************************//**
+ *  Arm the timer for the earliest alarm, with the lock held.
+ ******************************************************************************/
+static void rtc_ds1307_alarm_arm(void)
+{
+    struct timeval tv;
+    int64_t delay_us;
+
+    esp_timer_stop(alarm_timer);
+    if(alarm_count == 0) {
+        return;
+    }
+    gettimeofday(&tv, NULL);
+    delay_us = ((int64_t)rtc_ds1307_alarm_when(0) - tv.tv_sec) * 1000000
+               - tv.tv_usec;
+    esp_timer_start_once(alarm_timer, (delay_us > 0) ? delay_us : 1);
+}
+
+/***************************************************************************//**
+ *  Timer callback, run the alarms that are due.
+ ******************************************************************************/
+static void rtc_ds1307_alarm_timer_cb(void *arg)
+{
+    for(;;) {
+        rtc_ds1307_alarm_slot_t *alarm;
+        rtc_ds1307_alarm_cb_t callback;
+        void *callback_arg;
+        uint8_t slot;
+        int id;
+        time_t now = time(NULL);
+
+        xSemaphoreTake(alarm_lock, portMAX_DELAY);
+        if((alarm_count == 0) || (rtc_ds1307_alarm_when(0) > now)) {
+            // Woken early, e.g. by a slewing system time
+            rtc_ds1307_alarm_arm();
+            xSemaphoreGive(alarm_lock);
+            return;
+        }
+        slot = alarm_heap[0];
+        alarm = &alarm_slot[slot];
+        callback = alarm->callback;
+        callback_arg = alarm->arg;
+        id = rtc_ds1307_alarm_id(slot);
+        if(alarm->period_s > 0) {
+            // Skip the occurrences missed, fire once for all of them
+            alarm->when += ((now - alarm->when) / alarm->period_s + 1)
+                           * alarm->period_s;
+            rtc_ds1307_alarm_sift(0);
+        } else {
+            rtc_ds1307_alarm_remove(slot);
+        }
+        xSemaphoreGive(alarm_lock);
+
+        // Unlocked, the callback may add or cancel alarms
+        callback(id, callback_arg);
+    }
+}
+
+// -----------------------------------------------------------------------------
+//                               Public functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Start the alarm service.
+ ******************************************************************************/
+esp_err_t rtc_ds1307_alarm_init(void)
+{
+    const esp_timer_create_args_t args = {
+        .callback = rtc_ds1307_alarm_timer_cb,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "rtc_alarm",
+    };
+
+    if(alarm_lock != NULL) {
+        return ESP_OK;
+    }
+    if(esp_timer_create(&args, &alarm_timer) != ESP_OK) {
+        return ESP_ERR_NO_MEM;
+    }
+    alarm_lock = xSemaphoreCreateMutex();
+    if(alarm_lock == NULL) {
+        esp_timer_delete(alarm_timer);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+/***************************************************************************//**
+ *  Add an alarm.
+ ******************************************************************************/
+esp_err_t rtc_ds1307_alarm_add(time_t when, uint32_t period_s,
+                               rtc_ds1307_alarm_cb_t callback, void *arg,
+                               int *id)
+{
+    uint8_t slot;
+    uint16_t generation;
+
+    if(callback == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if(alarm_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(alarm_lock, portMAX_DELAY);
+    for(slot = 0; slot < RTC_DS1307_ALARM_MAX; slot++) {
+        if(!alarm_slot[slot].used) {
+            break;
+        }
+    }
+    if(slot == RTC_DS1307_ALARM_MAX) {
+        xSemaphoreGive(alarm_lock);
+        return ESP_ERR_NO_MEM;
+    }
+    generation = alarm_slot[slot].generation + 1;
+    alarm_slot[slot] = (rtc_ds1307_alarm_slot_t) {
+        .when = when,
+        .period_s = period_s,
+        .callback = callback,
+        .arg = arg,
+        .generation = generation,
+        .used = true,
+    };
+    rtc_ds1307_alarm_place(alarm_count++, slot);
+    rtc_ds1307_alarm_sift(alarm_slot[slot].heap_pos);
+    if(alarm_heap[0] == slot) {
+        rtc_ds1307_alarm_arm();
+    }
+    if(id != NULL) {
+        *id = rtc_ds1307_alarm_id(slot);
+    }
+    xSemaphoreGive(alarm_lock);
+
+    return ESP_OK;
+}
+
+/***************************************************************************//**
+ *  Cancel a pending alarm.
+ ******************************************************************************/
+esp_err_t rtc_ds1307_alarm_cancel(int id)
+{
+    esp_err_t status = ESP_ERR_NOT_FOUND;
+    uint8_t slot = (uint8_t)(id % RTC_DS1307_ALARM_MAX);
+
+    if(alarm_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(alarm_lock, portMAX_DELAY);
+    if((id >= 0) && alarm_slot[slot].used
+       && (rtc_ds1307_alarm_id(slot) == id)) {
+        bool first = (alarm_slot[slot].heap_pos == 0);
+        rtc_ds1307_alarm_remove(slot);
+        if(first) {
+            rtc_ds1307_alarm_arm();
+        }
+        status = ESP_OK;
+    }
+    xSemaphoreGive(alarm_lock);
+    return status;
+}
+
+/***************************************************************************//**
+ *  Re-arm the timer after a time step.
+ ******************************************************************************/
+void rtc_ds1307_alarm_time_changed(void)
+{
+    if(alarm_lock == NULL) {
+        return;
+    }
+    xSemaphoreTake(alarm_lock, portMAX_DELAY);
+    rtc_ds1307_alarm_arm();
+    xSemaphoreGive(alarm_lock);
+}
+
+/***************************************************************************//**
+ *  Next occurrence of a time of day.
+ ******************************************************************************/
+time_t rtc_ds1307_alarm_next_daily(uint8_t hour, uint8_t minute,
+                                   uint8_t second)
+{
+    time_t now = time(NULL);
+    time_t today = now - now % 86400;
+    time_t when = today + hour * 3600 + minute * 60 + second;
+
+    return (when > now) ? when : when + 86400;
+}
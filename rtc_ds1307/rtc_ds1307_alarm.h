@@ -0,0 +1,111 @@
+#ifndef _RTC_DS1307_ALARM_H_
+#define _RTC_DS1307_ALARM_H_
+
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <time.h>
+#include "esp_err.h"
+
+// -----------------------------------------------------------------------------
+//                               Macros
+// -----------------------------------------------------------------------------
+
+// largest number of pending alarms
+#ifndef RTC_DS1307_ALARM_MAX
+#define RTC_DS1307_ALARM_MAX    16
+#endif
+
+// -----------------------------------------------------------------------------
+//                               Typedefs
+// -----------------------------------------------------------------------------
+
+typedef void (*rtc_ds1307_alarm_cb_t)(int id, void *arg); /* alarm callback */
+
+// -----------------------------------------------------------------------------
+//                               Public functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ * @brief
+ *  Start the alarm service. Alarms are wall-clock deadlines on the system
+ *  time (time()), kept in a min-heap and served by a single esp_timer that
+ *  sleeps until the earliest one, so nothing polls the RTC. Set the system
+ *  time first, e.g. with rtc_ds1307_systime_sync().
+ *
+ * @retval ESP_OK         Success
+ * @retval ESP_ERR_NO_MEM The timer or the lock can not be created
+ ******************************************************************************/
+esp_err_t rtc_ds1307_alarm_init(void);
+
+/***************************************************************************//**
+ * @brief
+ *  Add an alarm. The callback runs in the esp_timer task and must not
+ *  block; it may add and cancel alarms. An alarm already past fires at
+ *  once. A recurring alarm that missed occurrences, e.g. after the time was
+ *  stepped forward, fires once and moves to its next future occurrence.
+ *
+ * @param[in] when
+ *  The first deadline in Unix time, see rtc_ds1307_alarm_next_daily().
+ * @param[in] period_s
+ *  The time between occurrences, 0 for a one-shot alarm.
+ * @param[in] callback
+ *  The function to call.
+ * @param[in] arg
+ *  The argument of the callback.
+ * @param[out] id
+ *  The alarm id for rtc_ds1307_alarm_cancel(), may be NULL. Ids are not
+ *  reused while the alarm is pending, and an id kept after a one-shot
+ *  alarm fired or was cancelled does not match a later alarm.
+ *
+ * @retval ESP_OK                Success
+ * @retval ESP_ERR_INVALID_ARG   The callback is NULL
+ * @retval ESP_ERR_INVALID_STATE The service is not started
+ * @retval ESP_ERR_NO_MEM        RTC_DS1307_ALARM_MAX alarms are pending
+ ******************************************************************************/
+esp_err_t rtc_ds1307_alarm_add(time_t when, uint32_t period_s,
+                               rtc_ds1307_alarm_cb_t callback, void *arg,
+                               int *id);
+
+/***************************************************************************//**
+ * @brief
+ *  Cancel a pending alarm.
+ *
+ * @param[in] id
+ *  The alarm id.
+ *
+ * @retval ESP_OK                Success
+ * @retval ESP_ERR_NOT_FOUND     No alarm is pending with this id
+ * @retval ESP_ERR_INVALID_STATE The service is not started
+ ******************************************************************************/
+esp_err_t rtc_ds1307_alarm_cancel(int id);
+
+/***************************************************************************//**
+ * @brief
+ *  Re-arm the timer after the system time was stepped. esp_timer counts
+ *  monotonic time, so without this a step delays or advances every alarm
+ *  by the size of the step. Register it with rtc_ds1307_systime_on_step().
+ ******************************************************************************/
+void rtc_ds1307_alarm_time_changed(void);
+
+/***************************************************************************//**
+ * @brief
+ *  Get the next occurrence of a time of day, in UTC, after the current
+ *  system time. With a period of 86400 it makes a daily alarm.
+ *
+ * @param[in] hour
+ *  The hour, 0 to 23.
+ * @param[in] minute
+ *  The minute, 0 to 59.
+ * @param[in] second
+ *  The second, 0 to 59.
+ *
+ * @return
+ *  The next occurrence in Unix time.
+ ******************************************************************************/
+time_t rtc_ds1307_alarm_next_daily(uint8_t hour, uint8_t minute,
+                                   uint8_t second);
+
+#endif /* _RTC_DS1307_ALARM_H_ */
@@ -0,0 +1,494 @@
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "rtc_ds1307_clock.h"
+
+// -----------------------------------------------------------------------------
+//                               Macros
+// -----------------------------------------------------------------------------
+
+// reads of DS1307 that may be hit by a square wave edge before giving up
+#define SQW_READ_ATTEMPTS   3
+// reads are kept this far from the next square wave edge, in ms; the
+// register advances on the edge but the count only after the ISR latency
+#define SQW_EDGE_GUARD_MS   20
+
+// -----------------------------------------------------------------------------
+//                               Local variables
+// -----------------------------------------------------------------------------
+
+static portMUX_TYPE clock_mux = portMUX_INITIALIZER_UNLOCKED;
+static time_t clock_base;               // DS1307 time at clock_base_us
+static int64_t clock_base_us;           // start of the second clock_base
+static int64_t clock_next_sync_us;
+static int64_t clock_interval_us;
+static bool clock_align;
+static bool clock_valid;
+static TaskHandle_t clock_task;         // periodic resync
+static time_t clock_last;               // latest time returned
+
+// square wave mode: the base is the time at edge count clock_base_ticks
+static gpio_num_t clock_sqw_pin = GPIO_NUM_NC;
+static volatile uint32_t clock_ticks;
+static volatile int64_t clock_edge_us;  // esp_timer time of the last edge
+static uint32_t clock_base_ticks;
+static uint32_t clock_mismatches;
+
+// drift correction: DS1307 gains clock_drift_ppb from clock_anchor on
+static int32_t clock_drift_ppb;
+static time_t clock_anchor;
+
+// -----------------------------------------------------------------------------
+//                               Local functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Read DS1307 and find the start of the current second.
+ ******************************************************************************/
+static esp_err_t rtc_ds1307_clock_read(date_time_t *dt, int64_t *start_us)
+{
+    esp_err_t status;
+
+    if(!clock_align) {
+        status = rtc_ds1307_get_current_date_time(dt);
+        // Clock halted (CH bit set), keep what was read
+        if((status != ESP_OK) && (status != ESP_ERR_INVALID_STATE)) {
+            return status;
+        }
+        // Unknown phase, assume the read fell in the middle of the second
+        *start_us = esp_timer_get_time() - 500000;
+        return ESP_OK;
+    }
+
+    status = rtc_ds1307_clock_read_aligned(dt, start_us);
+    // Clock halted (CH bit set), keep what was read
+    return (status == ESP_ERR_TIMEOUT) ? ESP_OK : status;
+}
+
+/***************************************************************************//**
+ *  Square wave falling edge, one more second.
+ ******************************************************************************/
+static void IRAM_ATTR rtc_ds1307_clock_sqw_isr(void *arg)
+{
+    clock_edge_us = esp_timer_get_time();
+    clock_ticks++;
+}
+
+/***************************************************************************//**
+ *  Read DS1307 between two square wave edges.
+ ******************************************************************************/
+static esp_err_t rtc_ds1307_clock_read_sqw(date_time_t *dt, uint32_t *ticks)
+{
+    esp_err_t status = ESP_FAIL;
+
+    for(uint8_t i = 0; i < SQW_READ_ATTEMPTS; i++) {
+        uint32_t before = clock_ticks;
+        int64_t since_edge = esp_timer_get_time() - clock_edge_us;
+
+        // Close to the next edge the register may tick before the count
+        // does, wait until the edge is past
+        if((before != 0)
+           && (since_edge > 1000000 - SQW_EDGE_GUARD_MS * 1000)
+           && (since_edge < 1000000 + SQW_EDGE_GUARD_MS * 1000)) {
+            vTaskDelay(pdMS_TO_TICKS(2 * SQW_EDGE_GUARD_MS) + 1);
+            continue;
+        }
+        status = rtc_ds1307_get_current_date_time(dt);
+        // Clock halted (CH bit set), keep what was read
+        if(status == ESP_ERR_INVALID_STATE) {
+            status = ESP_OK;
+        }
+        if(status != ESP_OK) {
+            return status;
+        }
+        // The register belongs to the second of the last edge
+        if(clock_ticks == before) {
+            *ticks = before;
+            return ESP_OK;
+        }
+    }
+    return status == ESP_OK ? ESP_ERR_TIMEOUT : status;
+}
+
+/***************************************************************************//**
+ *  Restart the square wave count from DS1307 if it drifted.
+ ******************************************************************************/
+static esp_err_t rtc_ds1307_clock_resync_sqw(bool allow_backward)
+{
+    date_time_t dt;
+    time_t now = 0, corrected = 0;
+    uint32_t ticks;
+    esp_err_t status = rtc_ds1307_clock_read_sqw(&dt, &ticks);
+
+    if(status == ESP_OK) {
+        now = rtc_ds1307_date_time_to_epoch(&dt);
+        // The floor is kept in the drift corrected time get() returns
+        corrected = rtc_ds1307_clock_correct_us((int64_t)now * 1000000)
+                    / 1000000;
+    }
+    portENTER_CRITICAL(&clock_mux);
+    if(status == ESP_OK) {
+        if(clock_valid && (now != clock_base + (ticks - clock_base_ticks))) {
+            clock_mismatches++;
+        }
+        if(allow_backward) {
+            clock_last = corrected;
+        }
+        clock_base = now;
+        clock_base_ticks = ticks;
+        clock_valid = true;
+        clock_next_sync_us = clock_interval_us
+                             ? esp_timer_get_time() + clock_interval_us
+                             : INT64_MAX;
+    } else {
+        clock_next_sync_us = esp_timer_get_time()
+                             + RTC_DS1307_CLOCK_RETRY_MS * 1000;
+    }
+    portEXIT_CRITICAL(&clock_mux);
+    return status;
+}
+
+/***************************************************************************//**
+ *  Restart the extrapolation from DS1307.
+ ******************************************************************************/
+static esp_err_t rtc_ds1307_clock_resync(bool allow_backward)
+{
+    date_time_t dt;
+    time_t now = 0, corrected = 0;
+    int64_t start_us;
+    esp_err_t status;
+
+    if(clock_sqw_pin != GPIO_NUM_NC) {
+        return rtc_ds1307_clock_resync_sqw(allow_backward);
+    }
+
+    status = rtc_ds1307_clock_read(&dt, &start_us);
+    if(status == ESP_OK) {
+        now = rtc_ds1307_date_time_to_epoch(&dt);
+        // The floor is kept in the drift corrected time get() returns
+        corrected = rtc_ds1307_clock_correct_us((int64_t)now * 1000000)
+                    / 1000000;
+    }
+    portENTER_CRITICAL(&clock_mux);
+    if(status == ESP_OK) {
+        if(allow_backward) {
+            clock_last = corrected;
+        }
+        clock_base = now;
+        clock_base_us = start_us;
+        clock_valid = true;
+        clock_next_sync_us = clock_interval_us ? start_us + clock_interval_us
+                                               : INT64_MAX;
+    } else {
+        clock_next_sync_us = esp_timer_get_time()
+                             + RTC_DS1307_CLOCK_RETRY_MS * 1000;
+    }
+    portEXIT_CRITICAL(&clock_mux);
+    return status;
+}
+
+/***************************************************************************//**
+ *  Resync task, so rtc_ds1307_clock_get() never waits for DS1307.
+ ******************************************************************************/
+static void rtc_ds1307_clock_task(void *arg)
+{
+    for(;;) {
+        int64_t wait_us;
+
+        portENTER_CRITICAL(&clock_mux);
+        wait_us = clock_next_sync_us - esp_timer_get_time();
+        portEXIT_CRITICAL(&clock_mux);
+
+        if(wait_us <= 0) {
+            rtc_ds1307_clock_resync(false);
+            continue;
+        }
+        // At most an hour in ticks, init wakes the task to a new interval
+        if(wait_us > 3600000000LL) {
+            wait_us = 3600000000LL;
+        }
+        ulTaskNotifyTake(pdTRUE, (TickType_t)(wait_us / 1000)
+                                 * configTICK_RATE_HZ / 1000 + 1);
+    }
+}
+
+/***************************************************************************//**
+ *  Start the resync task, or wake it to the new interval.
+ ******************************************************************************/
+static esp_err_t rtc_ds1307_clock_start_task(void)
+{
+    if(clock_task != NULL) {
+        xTaskNotifyGive(clock_task);
+        return ESP_OK;
+    }
+    if(clock_interval_us == 0) {
+        return ESP_OK;
+    }
+    if(xTaskCreate(rtc_ds1307_clock_task, "rtc_clock",
+                   RTC_DS1307_CLOCK_TASK_STACK, NULL,
+                   RTC_DS1307_CLOCK_TASK_PRIORITY, &clock_task) != pdPASS) {
+        clock_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+// -----------------------------------------------------------------------------
+//                               Public functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Read DS1307 at the start of a second.
+ ******************************************************************************/
+esp_err_t rtc_ds1307_clock_read_aligned(date_time_t *dt, int64_t *start_us)
+{
+    uint8_t first, seconds;
+    int64_t deadline;
+    esp_err_t status;
+
+    // Poll the seconds register alone, one byte per poll instead of seven
+    status = rtc_ds1307_read_registers(0x00, &first, 1);
+    if(status != ESP_OK) {
+        return status;
+    }
+    deadline = esp_timer_get_time() + RTC_DS1307_CLOCK_ALIGN_TIMEOUT_MS * 1000;
+    while(esp_timer_get_time() < deadline) {
+        vTaskDelay(pdMS_TO_TICKS(RTC_DS1307_CLOCK_ALIGN_POLL_MS));
+        status = rtc_ds1307_read_registers(0x00, &seconds, 1);
+        if(status != ESP_OK) {
+            return status;
+        }
+        if(seconds != first) {
+            // The tick happened during the last poll period
+            *start_us = esp_timer_get_time()
+                        - RTC_DS1307_CLOCK_ALIGN_POLL_MS * 500;
+            return rtc_ds1307_get_current_date_time(dt);
+        }
+    }
+    // Clock halted (CH bit set), the frozen time comes with INVALID_STATE
+    status = rtc_ds1307_get_current_date_time(dt);
+    *start_us = esp_timer_get_time();
+    return ((status == ESP_OK) || (status == ESP_ERR_INVALID_STATE))
+           ? ESP_ERR_TIMEOUT : status;
+}
+
+/***************************************************************************//**
+ *  Start the cached clock.
+ ******************************************************************************/
+esp_err_t rtc_ds1307_clock_init(uint32_t resync_interval_s,
+                                bool align_rollover)
+{
+    esp_err_t status;
+
+    clock_interval_us = (int64_t)resync_interval_s * 1000000;
+    clock_align = align_rollover;
+    status = rtc_ds1307_clock_sync();
+    // A failed first read is retried by the task
+    if(rtc_ds1307_clock_start_task() != ESP_OK) {
+        return ESP_ERR_NO_MEM;
+    }
+    return status;
+}
+
+/***************************************************************************//**
+ *  Start the cached clock driven by the square wave.
+ ******************************************************************************/
+esp_err_t rtc_ds1307_clock_init_sqw(gpio_num_t pin,
+                                    uint32_t verify_interval_s)
+{
+    esp_err_t status = rtc_ds1307_set_sqw(RTC_DS1307_SQW_1HZ);
+
+    if(status != ESP_OK) {
+        return status;
+    }
+    gpio_set_direction(pin, GPIO_MODE_INPUT);
+    gpio_set_pull_mode(pin, GPIO_PULLUP_ONLY);
+    gpio_set_intr_type(pin, GPIO_INTR_NEGEDGE);
+    status = gpio_install_isr_service(0);
+    if((status != ESP_OK) && (status != ESP_ERR_INVALID_STATE)) {
+        return status;
+    }
+    status = gpio_isr_handler_add(pin, rtc_ds1307_clock_sqw_isr, NULL);
+    if(status != ESP_OK) {
+        return status;
+    }
+
+    clock_interval_us = (int64_t)verify_interval_s * 1000000;
+    clock_sqw_pin = pin;
+    clock_valid = false;
+    status = rtc_ds1307_clock_sync();
+    // A failed first read is retried by the task
+    if(rtc_ds1307_clock_start_task() != ESP_OK) {
+        return ESP_ERR_NO_MEM;
+    }
+    return status;
+}
+
+/***************************************************************************//**
+ *  Number of square wave mismatches.
+ ******************************************************************************/
+uint32_t rtc_ds1307_clock_get_mismatches(void)
+{
+    return clock_mismatches;
+}
+
+/***************************************************************************//**
+ *  Read DS1307 now.
+ ******************************************************************************/
+esp_err_t rtc_ds1307_clock_sync(void)
+{
+    return rtc_ds1307_clock_resync(true);
+}
+
+/***************************************************************************//**
+ *  Get the current date and time.
+ ******************************************************************************/
+esp_err_t rtc_ds1307_clock_get(date_time_t *dt)
+{
+    int64_t now = esp_timer_get_time();
+    int64_t base_us, raw_us;
+    uint32_t elapsed;
+    bool valid;
+    time_t epoch;
+
+    portENTER_CRITICAL(&clock_mux);
+    valid = clock_valid;
+    epoch = clock_base;
+    base_us = clock_base_us;
+    elapsed = clock_ticks - clock_base_ticks;
+    portEXIT_CRITICAL(&clock_mux);
+
+    if(!valid) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if(clock_sqw_pin == GPIO_NUM_NC) {
+        raw_us = (int64_t)epoch * 1000000 + ((now > base_us) ? now - base_us
+                                                             : 0);
+    } else {
+        raw_us = ((int64_t)epoch + elapsed) * 1000000;
+    }
+    epoch = rtc_ds1307_clock_correct_us(raw_us) / 1000000;
+
+    // A resync that lands behind the extrapolation must not step back
+    portENTER_CRITICAL(&clock_mux);
+    if(epoch < clock_last) {
+        epoch = clock_last;
+    } else {
+        clock_last = epoch;
+    }
+    portEXIT_CRITICAL(&clock_mux);
+    rtc_ds1307_epoch_to_date_time(epoch, dt);
+    return ESP_OK;
+}
+
+/***************************************************************************//**
+ *  Measure the drift of DS1307.
+ ******************************************************************************/
+esp_err_t rtc_ds1307_clock_calibrate(uint32_t window_s,
+                                     int64_t (*reference_us)(void),
+                                     int32_t *drift_ppb)
+{
+    date_time_t dt;
+    time_t rtc_start, rtc_end;
+    int64_t tick_us, ref_start, ref_end, rtc_elapsed, ref_elapsed, diff_us;
+    int32_t ppb;
+    esp_err_t status;
+
+    if(window_s == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Both ends on a DS1307 tick, the reference taken at the same instant
+    status = rtc_ds1307_clock_read_aligned(&dt, &tick_us);
+    if(status != ESP_OK) {
+        return (status == ESP_ERR_TIMEOUT) ? ESP_ERR_INVALID_STATE : status;
+    }
+    ref_start = (reference_us != NULL)
+                ? reference_us() - (esp_timer_get_time() - tick_us) : tick_us;
+    rtc_start = rtc_ds1307_date_time_to_epoch(&dt);
+
+    // In hours, a whole window in ticks overflows at high tick rates
+    for(uint32_t left = window_s; left > 0; ) {
+        uint32_t chunk = (left > 3600) ? 3600 : left;
+        vTaskDelay((TickType_t)chunk * configTICK_RATE_HZ);
+        left -= chunk;
+    }
+
+    status = rtc_ds1307_clock_read_aligned(&dt, &tick_us);
+    if(status != ESP_OK) {
+        return (status == ESP_ERR_TIMEOUT) ? ESP_ERR_INVALID_STATE : status;
+    }
+    ref_end = (reference_us != NULL)
+              ? reference_us() - (esp_timer_get_time() - tick_us) : tick_us;
+    rtc_end = rtc_ds1307_date_time_to_epoch(&dt);
+
+    rtc_elapsed = (int64_t)(rtc_end - rtc_start) * 1000000;
+    ref_elapsed = ref_end - ref_start;
+    if(ref_elapsed <= 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    diff_us = rtc_elapsed - ref_elapsed;
+    // A crystal is off by tens of ppm, beyond that something is broken
+    if((diff_us > ref_elapsed / 1000) || (diff_us < -ref_elapsed / 1000)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    ppb = diff_us * 1000000000 / ref_elapsed;
+
+    // Correct from here on, the offset already gained is left alone
+    rtc_ds1307_clock_set_drift(ppb, rtc_end);
+    if(drift_ppb != NULL) {
+        *drift_ppb = ppb;
+    }
+    return ESP_OK;
+}
+
+/***************************************************************************//**
+ *  Set the drift correction.
+ ******************************************************************************/
+void rtc_ds1307_clock_set_drift(int32_t drift_ppb, time_t anchor)
+{
+    portENTER_CRITICAL(&clock_mux);
+    clock_drift_ppb = drift_ppb;
+    clock_anchor = anchor;
+    // A new correction may step back like a sync, the floor starts over
+    clock_last = 0;
+    portEXIT_CRITICAL(&clock_mux);
+}
+
+/***************************************************************************//**
+ *  Get the drift correction.
+ ******************************************************************************/
+int32_t rtc_ds1307_clock_get_drift(time_t *anchor)
+{
+    int32_t drift_ppb;
+
+    portENTER_CRITICAL(&clock_mux);
+    drift_ppb = clock_drift_ppb;
+    if(anchor != NULL) {
+        *anchor = clock_anchor;
+    }
+    portEXIT_CRITICAL(&clock_mux);
+    return drift_ppb;
+}
+
+/***************************************************************************//**
+ *  Remove the drift from a DS1307 time.
+ ******************************************************************************/
+int64_t rtc_ds1307_clock_correct_us(int64_t rtc_us)
+{
+    int64_t since_us;
+    int32_t drift_ppb;
+
+    portENTER_CRITICAL(&clock_mux);
+    since_us = rtc_us - (int64_t)clock_anchor * 1000000;
+    drift_ppb = clock_drift_ppb;
+    portEXIT_CRITICAL(&clock_mux);
+
+    // ms * ppb / 1e6 = us, no overflow for centuries at any sane drift
+    return rtc_us - since_us / 1000 * drift_ppb / 1000000;
+}
@@ -0,0 +1,195 @@
+#ifndef _RTC_DS1307_CLOCK_H_
+#define _RTC_DS1307_CLOCK_H_
+
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+#include "rtc_ds1307.h"
+
+// -----------------------------------------------------------------------------
+//                               Macros
+// -----------------------------------------------------------------------------
+
+// longest wait for the seconds register to tick when aligning, in ms
+#define RTC_DS1307_CLOCK_ALIGN_TIMEOUT_MS   1100
+// poll period of the seconds register when aligning, in ms
+#define RTC_DS1307_CLOCK_ALIGN_POLL_MS      10
+// retry period after a failed resync, in ms
+#define RTC_DS1307_CLOCK_RETRY_MS           1000
+// stack size in bytes and priority of the resync task
+#define RTC_DS1307_CLOCK_TASK_STACK         3072
+#define RTC_DS1307_CLOCK_TASK_PRIORITY      5
+
+// -----------------------------------------------------------------------------
+//                               Public functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ * @brief
+ *  Start the cached clock: read DS1307 once, then extrapolate with
+ *  esp_timer_get_time(). rtc_ds1307_init() must be called first. A halted
+ *  DS1307 (CH bit set) is not an error, its frozen time is kept. The
+ *  resyncs run in a task started on the first call with an interval.
+ *
+ * @param[in] resync_interval_s
+ *  Time between two reads of DS1307, 0 never reads it again.
+ * @param[in] align_rollover
+ *  Poll the seconds register until it ticks on every read so the cached time
+ *  is in phase with DS1307 (within RTC_DS1307_CLOCK_ALIGN_POLL_MS). Without
+ *  it the read is assumed to fall mid-second, within +/-0.5 s.
+ *
+ * @retval ESP_OK         Success
+ * @retval ESP_ERR_NO_MEM The resync task cannot be created
+ * @retval ESP_FAIL       Fail, the task retries it with an interval
+ ******************************************************************************/
+esp_err_t rtc_ds1307_clock_init(uint32_t resync_interval_s,
+                                bool align_rollover);
+
+/***************************************************************************//**
+ * @brief
+ *  Start the cached clock driven by the DS1307 1 Hz square wave: SQW/OUT is
+ *  set to 1 Hz and every falling edge on the pin adds one second. DS1307 is
+ *  read at start and at each verification, a mismatch (missed or spurious
+ *  edge) restarts the count from the chip. rtc_ds1307_init() must be called
+ *  first.
+ *
+ * @param[in] pin
+ *  The GPIO connected to SQW/OUT, the internal pull-up is enabled.
+ * @param[in] verify_interval_s
+ *  Time between two verifications against DS1307, 0 never reads it again.
+ *  The verifications run in the same task as the resyncs.
+ *
+ * @retval ESP_OK         Success
+ * @retval ESP_ERR_NO_MEM The resync task cannot be created
+ * @retval ESP_FAIL       Fail, the task retries it with an interval
+ ******************************************************************************/
+esp_err_t rtc_ds1307_clock_init_sqw(gpio_num_t pin,
+                                    uint32_t verify_interval_s);
+
+/***************************************************************************//**
+ * @brief
+ *  Get how many verifications found the square wave count off DS1307.
+ *
+ * @return
+ *  The number of mismatches since start.
+ ******************************************************************************/
+uint32_t rtc_ds1307_clock_get_mismatches(void);
+
+/***************************************************************************//**
+ * @brief
+ *  Read DS1307 right after its seconds register ticks, for callers that need
+ *  the time with sub-second phase. Blocks up to
+ *  RTC_DS1307_CLOCK_ALIGN_TIMEOUT_MS.
+ *
+ * @param[out] dt
+ *  The date and time of the second that just started.
+ * @param[out] start_us
+ *  The esp_timer_get_time() of the tick, within
+ *  RTC_DS1307_CLOCK_ALIGN_POLL_MS / 2.
+ *
+ * @retval ESP_OK          Success
+ * @retval ESP_ERR_TIMEOUT The clock is halted (CH bit set), dt holds the
+ *                         frozen time and start_us the time of the read
+ * @retval ESP_FAIL        Fail
+ ******************************************************************************/
+esp_err_t rtc_ds1307_clock_read_aligned(date_time_t *dt, int64_t *start_us);
+
+/***************************************************************************//**
+ * @brief
+ *  Read DS1307 now and restart the extrapolation from it, e.g. after
+ *  rtc_ds1307_set_date_time(). A halted DS1307 (CH bit set) is not an error,
+ *  its frozen time is kept.
+ *
+ * @retval ESP_OK   Success
+ * @retval ESP_FAIL Fail, the previous extrapolation is kept
+ ******************************************************************************/
+esp_err_t rtc_ds1307_clock_sync(void);
+
+/***************************************************************************//**
+ * @brief
+ *  Get the current date and time from the cached clock, without I2C traffic
+ *  or waiting; the resyncs run in their own task. The time never goes
+ *  backwards, a resync that lands behind the extrapolation holds it until
+ *  DS1307 catches up; only rtc_ds1307_clock_sync() may step it back.
+ *
+ * @param[out] dt
+ *  The current date and time.
+ *
+ * @retval ESP_OK                Success
+ * @retval ESP_ERR_INVALID_STATE The clock was never synchronized
+ ******************************************************************************/
+esp_err_t rtc_ds1307_clock_get(date_time_t *dt);
+
+/***************************************************************************//**
+ * @brief
+ *  Measure the drift of DS1307 against a reference over a window: DS1307 is
+ *  read on a tick at both ends and the reference is sampled at the same
+ *  instants. The result is applied with rtc_ds1307_clock_set_drift(),
+ *  anchored at the end of the window. Resolution is about
+ *  RTC_DS1307_CLOCK_ALIGN_POLL_MS / window_s, e.g. 3 ppm over an hour and
+ *  0.12 ppm over a day. Blocks for the window plus up to two seconds.
+ *
+ * @param[in] window_s
+ *  The measurement window, at most about 100 days.
+ * @param[in] reference_us
+ *  Function returning the reference time in us, e.g. gettimeofday() kept
+ *  by SNTP, or NULL for esp_timer_get_time().
+ * @param[out] drift_ppb
+ *  The drift in parts per billion (1000 ppb = 1 ppm), positive when DS1307
+ *  runs fast. May be NULL.
+ *
+ * @retval ESP_OK                Success
+ * @retval ESP_ERR_INVALID_ARG   The window is 0
+ * @retval ESP_ERR_INVALID_STATE DS1307 is halted, or off the reference by
+ *                               more than 1000 ppm
+ * @retval ESP_FAIL              Fail
+ ******************************************************************************/
+esp_err_t rtc_ds1307_clock_calibrate(uint32_t window_s,
+                                     int64_t (*reference_us)(void),
+                                     int32_t *drift_ppb);
+
+/***************************************************************************//**
+ * @brief
+ *  Set the drift correction applied to every time this module returns and
+ *  to the system time set by rtc_ds1307_systime. DS1307 is taken as right
+ *  at the anchor and off by drift_ppb * (t - anchor) at time t. Store both
+ *  values, e.g. with rtc_ds1307_kv, and set them again at boot; set a new
+ *  anchor after rtc_ds1307_set_date_time(). Like rtc_ds1307_clock_sync(),
+ *  a new correction may step the time back.
+ *
+ * @param[in] drift_ppb
+ *  The drift in parts per billion, 0 disables the correction.
+ * @param[in] anchor
+ *  The DS1307 time, in Unix time, from which the drift accumulates.
+ ******************************************************************************/
+void rtc_ds1307_clock_set_drift(int32_t drift_ppb, time_t anchor);
+
+/***************************************************************************//**
+ * @brief
+ *  Get the drift correction.
+ *
+ * @param[out] anchor
+ *  The anchor of the correction, may be NULL.
+ *
+ * @return
+ *  The drift in parts per billion.
+ ******************************************************************************/
+int32_t rtc_ds1307_clock_get_drift(time_t *anchor);
+
+/***************************************************************************//**
+ * @brief
+ *  Remove the drift from a time read on DS1307.
+ *
+ * @param[in] rtc_us
+ *  The DS1307 time in us since the epoch.
+ *
+ * @return
+ *  The corrected time in us since the epoch.
+ ******************************************************************************/
+int64_t rtc_ds1307_clock_correct_us(int64_t rtc_us);
+
+#endif /* _RTC_DS1307_CLOCK_H_ */
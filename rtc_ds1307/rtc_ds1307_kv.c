@@ -0,0 +1,180 @@
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <string.h>
+#include "rtc_ds1307_kv.h"
+
+// -----------------------------------------------------------------------------
+//                               Macros
+// -----------------------------------------------------------------------------
+
+// The sequence number is the last byte sent, a copy torn by a power loss
+// still carries the old one and can not win even if its CRC matches
+#define COPY_CRC            RTC_DS1307_KV_VALUE_SIZE
+#define COPY_SEQ            (RTC_DS1307_KV_VALUE_SIZE + 1)
+#define NO_COPY             0xFF
+
+// -----------------------------------------------------------------------------
+//                               Local variables
+// -----------------------------------------------------------------------------
+
+static uint8_t kv_mirror[RTC_DS1307_KV_NVRAM_USED];  // NVRAM as last written
+static uint8_t kv_current[RTC_DS1307_KV_SLOTS];      // copy 0/1 or NO_COPY
+static uint8_t kv_unknown[RTC_DS1307_KV_SLOTS];      // copies whose NVRAM
+                                                     // content is unsure
+static bool kv_loaded;
+
+// -----------------------------------------------------------------------------
+//                               Local functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  CRC-8 (polynomial 0x31, init 0xFF) of a copy, the key included so a copy
+ *  can not pass for another key.
+ ******************************************************************************/
+static uint8_t rtc_ds1307_kv_crc(uint8_t key, const uint8_t *copy)
+{
+    uint8_t crc = 0xFF;
+
+    // key, value then sequence number
+    for(int8_t i = -1; i <= RTC_DS1307_KV_VALUE_SIZE; i++) {
+        crc ^= (i < 0) ? key
+                       : copy[(i < RTC_DS1307_KV_VALUE_SIZE) ? i : COPY_SEQ];
+        for(uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+/***************************************************************************//**
+ *  Mirror of one copy of a record.
+ ******************************************************************************/
+static uint8_t *rtc_ds1307_kv_copy(uint8_t key, uint8_t copy)
+{
+    return kv_mirror + key * RTC_DS1307_KV_RECORD_SIZE
+           + copy * RTC_DS1307_KV_COPY_SIZE;
+}
+
+/***************************************************************************//**
+ *  Pick the current copy of a record.
+ ******************************************************************************/
+static uint8_t rtc_ds1307_kv_select(uint8_t key)
+{
+    uint8_t *a = rtc_ds1307_kv_copy(key, 0);
+    uint8_t *b = rtc_ds1307_kv_copy(key, 1);
+    bool a_valid = a[COPY_CRC] == rtc_ds1307_kv_crc(key, a);
+    bool b_valid = b[COPY_CRC] == rtc_ds1307_kv_crc(key, b);
+
+    if(a_valid && b_valid) {
+        // Sequence numbers wrap, the newer one is ahead by less than half
+        return ((int8_t)(b[COPY_SEQ] - a[COPY_SEQ]) > 0) ? 1 : 0;
+    }
+    if(a_valid) {
+        return 0;
+    }
+    return b_valid ? 1 : NO_COPY;
+}
+
+// -----------------------------------------------------------------------------
+//                               Public functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Load the record store.
+ ******************************************************************************/
+esp_err_t rtc_ds1307_kv_init(void)
+{
+    esp_err_t status = rtc_ds1307_nvram_read(0, kv_mirror,
+                                             RTC_DS1307_KV_NVRAM_USED);
+
+    if(status != ESP_OK) {
+        kv_loaded = false;
+        return status;
+    }
+    for(uint8_t key = 0; key < RTC_DS1307_KV_SLOTS; key++) {
+        kv_current[key] = rtc_ds1307_kv_select(key);
+        kv_unknown[key] = 0;
+    }
+    kv_loaded = true;
+    return ESP_OK;
+}
+
+/***************************************************************************//**
+ *  Get the value of a key.
+ ******************************************************************************/
+esp_err_t rtc_ds1307_kv_get(uint8_t key, void *value)
+{
+    if(key >= RTC_DS1307_KV_SLOTS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if(!kv_loaded) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if(kv_current[key] == NO_COPY) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    memcpy(value, rtc_ds1307_kv_copy(key, kv_current[key]),
+           RTC_DS1307_KV_VALUE_SIZE);
+    return ESP_OK;
+}
+
+/***************************************************************************//**
+ *  Set the value of a key.
+ ******************************************************************************/
+esp_err_t rtc_ds1307_kv_set(uint8_t key, const void *value)
+{
+    uint8_t next[RTC_DS1307_KV_COPY_SIZE];
+    uint8_t target, first, last;
+    uint8_t *copy;
+    esp_err_t status;
+
+    if(key >= RTC_DS1307_KV_SLOTS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if(!kv_loaded) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if(kv_current[key] == NO_COPY) {
+        target = 0;
+        next[COPY_SEQ] = 0;
+    } else {
+        copy = rtc_ds1307_kv_copy(key, kv_current[key]);
+        if(memcmp(copy, value, RTC_DS1307_KV_VALUE_SIZE) == 0) {
+            return ESP_OK;
+        }
+        target = kv_current[key] ^ 1;
+        next[COPY_SEQ] = copy[COPY_SEQ] + 1;
+    }
+    memcpy(next, value, RTC_DS1307_KV_VALUE_SIZE);
+    next[COPY_CRC] = rtc_ds1307_kv_crc(key, next);
+
+    // Send the span of bytes that differ from the copy being replaced
+    copy = rtc_ds1307_kv_copy(key, target);
+    first = 0;
+    last = RTC_DS1307_KV_COPY_SIZE - 1;
+    if(!(kv_unknown[key] & (1 << target))) {
+        while((first < last) && (copy[first] == next[first])) {
+            first++;
+        }
+        while((last > first) && (copy[last] == next[last])) {
+            last--;
+        }
+    }
+    // The sequence number always differs, so the span is never empty
+    status = rtc_ds1307_nvram_write(copy - kv_mirror + first,
+                                    next + first, last - first + 1);
+    if(status != ESP_OK) {
+        // The copy may be torn, the current one is untouched
+        kv_unknown[key] |= 1 << target;
+        return status;
+    }
+
+    memcpy(copy, next, RTC_DS1307_KV_COPY_SIZE);
+    kv_unknown[key] &= ~(1 << target);
+    kv_current[key] = target;
+    return ESP_OK;
+}
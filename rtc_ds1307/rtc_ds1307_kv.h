@@ -0,0 +1,87 @@
+#ifndef _RTC_DS1307_KV_H_
+#define _RTC_DS1307_KV_H_
+
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "rtc_ds1307.h"
+
+// -----------------------------------------------------------------------------
+//                               Macros
+// -----------------------------------------------------------------------------
+
+// size of every value in bytes
+#ifndef RTC_DS1307_KV_VALUE_SIZE
+#define RTC_DS1307_KV_VALUE_SIZE    4
+#endif
+
+// one copy of a record: value, CRC-8 and sequence number
+#define RTC_DS1307_KV_COPY_SIZE     (RTC_DS1307_KV_VALUE_SIZE + 2)
+// one record: copies A and B
+#define RTC_DS1307_KV_RECORD_SIZE   (2 * RTC_DS1307_KV_COPY_SIZE)
+// number of keys, 4 with the default value size
+#define RTC_DS1307_KV_SLOTS         (RTC_DS1307_NVRAM_SIZE \
+                                     / RTC_DS1307_KV_RECORD_SIZE)
+// NVRAM bytes used from offset 0, the rest is free for the application
+#define RTC_DS1307_KV_NVRAM_USED    (RTC_DS1307_KV_SLOTS \
+                                     * RTC_DS1307_KV_RECORD_SIZE)
+
+// -----------------------------------------------------------------------------
+//                               Public functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ * @brief
+ *  Load the record store from the DS1307 NVRAM in one burst read. Each key
+ *  has two copies; the valid one with the newer sequence number is current.
+ *  A copy torn by a power loss still holds its old sequence number, which
+ *  is written last, so the other copy stays current; the CRC alone would
+ *  let 1 torn copy in 256 through.
+ *  rtc_ds1307_init() must be called first. The store is not thread safe,
+ *  use it from one task.
+ *
+ * @retval ESP_OK   Success
+ * @retval ESP_FAIL Fail
+ ******************************************************************************/
+esp_err_t rtc_ds1307_kv_init(void);
+
+/***************************************************************************//**
+ * @brief
+ *  Get the current value of a key from the RAM mirror, without I2C traffic.
+ *
+ * @param[in] key
+ *  The key, 0 to RTC_DS1307_KV_SLOTS - 1.
+ * @param[out] value
+ *  RTC_DS1307_KV_VALUE_SIZE bytes.
+ *
+ * @retval ESP_OK                Success
+ * @retval ESP_ERR_INVALID_ARG   The key is out of range
+ * @retval ESP_ERR_INVALID_STATE The store is not loaded
+ * @retval ESP_ERR_NOT_FOUND     The key was never written, or both copies
+ *                               are corrupted
+ ******************************************************************************/
+esp_err_t rtc_ds1307_kv_get(uint8_t key, void *value);
+
+/***************************************************************************//**
+ * @brief
+ *  Set the value of a key. The new value goes to the older copy with the
+ *  next sequence number, so the current copy stays intact until the write
+ *  completes. Only the bytes that differ from what that copy holds are sent,
+ *  in one I2C transaction; an unchanged value sends nothing.
+ *
+ * @param[in] key
+ *  The key, 0 to RTC_DS1307_KV_SLOTS - 1.
+ * @param[in] value
+ *  RTC_DS1307_KV_VALUE_SIZE bytes.
+ *
+ * @retval ESP_OK                Success
+ * @retval ESP_ERR_INVALID_ARG   The key is out of range
+ * @retval ESP_ERR_INVALID_STATE The store is not loaded
+ * @retval ESP_FAIL              Fail, the previous value is still current
+ ******************************************************************************/
+esp_err_t rtc_ds1307_kv_set(uint8_t key, const void *value);
+
+#endif /* _RTC_DS1307_KV_H_ */
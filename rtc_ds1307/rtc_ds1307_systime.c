@@ -0,0 +1,179 @@
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <sys/time.h>
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "rtc_ds1307_clock.h"
+#include "rtc_ds1307_systime.h"
+
+// -----------------------------------------------------------------------------
+//                               Local variables
+// -----------------------------------------------------------------------------
+
+static TaskHandle_t systime_task;
+static volatile bool systime_stop;
+static uint32_t systime_interval_s;
+static int64_t systime_step_us;
+static volatile int64_t systime_offset_us;
+static void (*systime_step_cb)(void);
+
+// -----------------------------------------------------------------------------
+//                               Local functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Measure DS1307 time minus system time.
+ ******************************************************************************/
+static esp_err_t rtc_ds1307_systime_measure(int64_t *offset_us)
+{
+    date_time_t dt;
+    struct timeval tv;
+    int64_t start_us, system_us;
+    esp_err_t status = rtc_ds1307_clock_read_aligned(&dt, &start_us);
+
+    if(status == ESP_ERR_TIMEOUT) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if(status != ESP_OK) {
+        return status;
+    }
+
+    // System time at the DS1307 tick
+    gettimeofday(&tv, NULL);
+    system_us = (int64_t)tv.tv_sec * 1000000 + tv.tv_usec
+                - (esp_timer_get_time() - start_us);
+    *offset_us = rtc_ds1307_clock_correct_us(
+                     (int64_t)rtc_ds1307_date_time_to_epoch(&dt) * 1000000)
+                 - system_us;
+    systime_offset_us = *offset_us;
+    return ESP_OK;
+}
+
+/***************************************************************************//**
+ *  Step the system time.
+ ******************************************************************************/
+static void rtc_ds1307_systime_step(int64_t offset_us)
+{
+    struct timeval tv;
+    int64_t now_us;
+
+    gettimeofday(&tv, NULL);
+    now_us = (int64_t)tv.tv_sec * 1000000 + tv.tv_usec + offset_us;
+    tv.tv_sec = now_us / 1000000;
+    tv.tv_usec = now_us % 1000000;
+    settimeofday(&tv, NULL);
+    if(systime_step_cb != NULL) {
+        systime_step_cb();
+    }
+}
+
+/***************************************************************************//**
+ *  Comparison task.
+ ******************************************************************************/
+static void rtc_ds1307_systime_task(void *arg)
+{
+    while(!systime_stop) {
+        int64_t offset_us;
+        int64_t magnitude;
+
+        ulTaskNotifyTake(pdTRUE,
+                         (TickType_t)systime_interval_s * configTICK_RATE_HZ);
+        if(systime_stop) {
+            break;
+        }
+        if(rtc_ds1307_systime_measure(&offset_us) != ESP_OK) {
+            continue;
+        }
+
+        magnitude = (offset_us < 0) ? -offset_us : offset_us;
+        if(magnitude > systime_step_us) {
+            rtc_ds1307_systime_step(offset_us);
+        } else if(magnitude >= RTC_DS1307_SYSTIME_DEADBAND_MS * 1000) {
+            // Replaces any slew still in progress, the offset is current
+            struct timeval delta = {
+                .tv_sec = offset_us / 1000000,
+                .tv_usec = offset_us % 1000000,
+            };
+            adjtime(&delta, NULL);
+        }
+    }
+
+    systime_task = NULL;
+    vTaskDelete(NULL);
+}
+
+// -----------------------------------------------------------------------------
+//                               Public functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Set the system time from DS1307.
+ ******************************************************************************/
+esp_err_t rtc_ds1307_systime_sync(void)
+{
+    int64_t offset_us;
+    esp_err_t status = rtc_ds1307_systime_measure(&offset_us);
+
+    if(status == ESP_OK) {
+        rtc_ds1307_systime_step(offset_us);
+    }
+    return status;
+}
+
+/***************************************************************************//**
+ *  Start the comparison task.
+ ******************************************************************************/
+esp_err_t rtc_ds1307_systime_start(uint32_t check_interval_s,
+                                   uint32_t step_threshold_ms,
+                                   uint32_t stack_size,
+                                   UBaseType_t priority)
+{
+    if(systime_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    systime_interval_s = check_interval_s;
+    systime_step_us = (int64_t)step_threshold_ms * 1000;
+    systime_stop = false;
+    if(xTaskCreate(rtc_ds1307_systime_task, "rtc_systime", stack_size, NULL,
+                   priority, &systime_task) != pdPASS) {
+        systime_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+/***************************************************************************//**
+ *  Stop the comparison task.
+ ******************************************************************************/
+void rtc_ds1307_systime_stop(void)
+{
+    TaskHandle_t task = systime_task;
+
+    systime_stop = true;
+    if(task != NULL) {
+        xTaskNotifyGive(task);
+    }
+    while(systime_task != NULL) {
+        vTaskDelay(pdMS_TO_TICKS(10) + 1);
+    }
+}
+
+/***************************************************************************//**
+ *  Set the function called after each step.
+ ******************************************************************************/
+void rtc_ds1307_systime_on_step(void (*callback)(void))
+{
+    systime_step_cb = callback;
+}
+
+/***************************************************************************//**
+ *  Offset found by the last comparison.
+ ******************************************************************************/
+int64_t rtc_ds1307_systime_get_offset_us(void)
+{
+    return systime_offset_us;
+}
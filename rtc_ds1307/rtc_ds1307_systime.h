@@ -0,0 +1,92 @@
+#ifndef _RTC_DS1307_SYSTIME_H_
+#define _RTC_DS1307_SYSTIME_H_
+
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "rtc_ds1307.h"
+
+// -----------------------------------------------------------------------------
+//                               Macros
+// -----------------------------------------------------------------------------
+
+// offsets below this are left alone, the measurement is good to about
+// RTC_DS1307_CLOCK_ALIGN_POLL_MS / 2, in ms
+#define RTC_DS1307_SYSTIME_DEADBAND_MS      20
+
+// -----------------------------------------------------------------------------
+//                               Public functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ * @brief
+ *  Set the system time (settimeofday) from DS1307, read at the start of a
+ *  second so the system clock is in phase with it. Afterwards time() and
+ *  gettimeofday() give the DS1307 time, in UTC, at memory speed.
+ *  rtc_ds1307_init() must be called first. Blocks up to about one second.
+ *
+ * @retval ESP_OK                Success
+ * @retval ESP_ERR_INVALID_STATE DS1307 is halted (CH bit set), its time is
+ *                               not valid and the system time is unchanged
+ * @retval ESP_FAIL              Fail
+ ******************************************************************************/
+esp_err_t rtc_ds1307_systime_sync(void);
+
+/***************************************************************************//**
+ * @brief
+ *  Start a task that compares the system time with DS1307 periodically.
+ *  Offsets up to step_threshold_ms are slewed out with adjtime(), so the
+ *  system time stays monotonic; larger ones are stepped with
+ *  settimeofday(). Offsets below RTC_DS1307_SYSTIME_DEADBAND_MS are
+ *  ignored. Call rtc_ds1307_systime_sync() at boot first.
+ *
+ * @param[in] check_interval_s
+ *  Time between two comparisons, e.g. 900 for four reads of DS1307 an hour.
+ * @param[in] step_threshold_ms
+ *  Largest offset corrected by slewing.
+ * @param[in] stack_size
+ *  The stack size of the task in bytes.
+ * @param[in] priority
+ *  The priority of the task.
+ *
+ * @retval ESP_OK                Success
+ * @retval ESP_ERR_INVALID_STATE The task is already running
+ * @retval ESP_ERR_NO_MEM        The task can not be created
+ ******************************************************************************/
+esp_err_t rtc_ds1307_systime_start(uint32_t check_interval_s,
+                                   uint32_t step_threshold_ms,
+                                   uint32_t stack_size,
+                                   UBaseType_t priority);
+
+/***************************************************************************//**
+ * @brief
+ *  Stop the comparison task and wait for it to exit. A slew in progress
+ *  runs to its end.
+ ******************************************************************************/
+void rtc_ds1307_systime_stop(void);
+
+/***************************************************************************//**
+ * @brief
+ *  Set a function called each time the system time is stepped, e.g.
+ *  rtc_ds1307_alarm_time_changed() so wall-clock timers are re-armed.
+ *  It runs in the task that stepped the time.
+ *
+ * @param[in] callback
+ *  The function, NULL for none.
+ ******************************************************************************/
+void rtc_ds1307_systime_on_step(void (*callback)(void));
+
+/***************************************************************************//**
+ * @brief
+ *  Get the offset found by the last comparison.
+ *
+ * @return
+ *  DS1307 time minus system time in microseconds, before correction.
+ ******************************************************************************/
+int64_t rtc_ds1307_systime_get_offset_us(void);
+
+#endif /* _RTC_DS1307_SYSTIME_H_ */
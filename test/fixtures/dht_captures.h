@@ -0,0 +1,142 @@
+/******************************************************************************
+*@file: dht_captures.h
+*@brief: edge captures of dht frames as dht_isr_handler() stores them, cycle
+*        counter at 240 MHz, starting with the release of the data line
+*******************************************************************************/
+#ifndef _DHT_CAPTURES_H_
+#define _DHT_CAPTURES_H_
+
+// -----------------------------------------------------------------------------
+//                              Includes
+// -----------------------------------------------------------------------------
+
+#include "dht_decode.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros
+// -----------------------------------------------------------------------------
+
+#define CAPTURE_TICKS_PER_US    240
+
+// -----------------------------------------------------------------------------
+//                              Variables
+// -----------------------------------------------------------------------------
+
+/* DHT22, 65.2 %RH and 35.1 C, the cycle counter wraps mid-frame */
+static const dht_edge_t capture_dht22_valid[] = {
+    {0xFFFF5630, 1}, {0xFFFF771C, 0}, {0xFFFFC493, 1}, {0x00000E7C, 0},
+    {0x00003E0B, 1}, {0x000052CE, 0}, {0x00008147, 1}, {0x0000996D, 0},
+    {0x0000C872, 1}, {0x0000DDBB, 0}, {0x00010ADD, 1}, {0x000122D6, 0},
+    {0x000156EC, 1}, {0x00017160, 0}, {0x00019F6E, 1}, {0x0001B4D3, 0},
+    {0x0001E7CA, 1}, {0x0002299E, 0}, {0x00025BB2, 1}, {0x0002759A, 0},
+    {0x0002A59F, 1}, {0x0002E7A9, 0}, {0x000314B6, 1}, {0x00032B91, 0},
+    {0x00035AA5, 1}, {0x000371FB, 0}, {0x0003A4A2, 1}, {0x0003BAEE, 0},
+    {0x0003EF24, 1}, {0x000430F9, 0}, {0x00046453, 1}, {0x0004A804, 0},
+    {0x0004DA58, 1}, {0x0004F243, 0}, {0x00051F86, 1}, {0x00053921, 0},
+    {0x00056B63, 1}, {0x0005861E, 0}, {0x0005B804, 1}, {0x0005CE5E, 0},
+    {0x00060003, 1}, {0x00061712, 0}, {0x000647E9, 1}, {0x00065E9A, 0},
+    {0x00068C85, 1}, {0x0006A687, 0}, {0x0006D522, 1}, {0x0006EFAA, 0},
+    {0x00072110, 1}, {0x0007389D, 0}, {0x00076C60, 1}, {0x0007B051, 0},
+    {0x0007E3BA, 1}, {0x0007F8E9, 0}, {0x0008271D, 1}, {0x000867BC, 0},
+    {0x000895DD, 1}, {0x0008ADA2, 0}, {0x0008DD38, 1}, {0x00091E61, 0},
+    {0x00094BE0, 1}, {0x00098F4C, 0}, {0x0009C198, 1}, {0x000A079A, 0},
+    {0x000A3574, 1}, {0x000A75B0, 0}, {0x000AA55C, 1}, {0x000AEB90, 0},
+    {0x000B18D1, 1}, {0x000B5EF4, 0}, {0x000B92DD, 1}, {0x000BD47F, 0},
+    {0x000C02CF, 1}, {0x000C45D1, 0}, {0x000C74BC, 1}, {0x000C8B5B, 0},
+    {0x000CB947, 1}, {0x000CFBB0, 0}, {0x000D2C52, 1}, {0x000D6F92, 0},
+    {0x000D9EFF, 1}, {0x000DE4ED, 0}, {0x000E17C7, 1}, {0x000E2FEE, 0},
+    {0x000E637E, 1},
+};
+
+/* DHT22, same frame with the 0 of bit 9 stretched to 51 us by noise */
+static const dht_edge_t capture_dht22_checksum[] = {
+    {0x12F42B57, 1}, {0x12F44B8A, 0}, {0x12F497BE, 1}, {0x12F4E19C, 0},
+    {0x12F51011, 1}, {0x12F52A1F, 0}, {0x12F55A39, 1}, {0x12F5750D, 0},
+    {0x12F5A3F7, 1}, {0x12F5BA42, 0}, {0x12F5ED17, 1}, {0x12F603D5, 0},
+    {0x12F63756, 1}, {0x12F64FEA, 0}, {0x12F6836D, 1}, {0x12F69C57, 0},
+    {0x12F6CD12, 1}, {0x12F7105E, 0}, {0x12F73D66, 1}, {0x12F75933, 0},
+    {0x12F78A35, 1}, {0x12F7CC44, 0}, {0x12F7FE29, 1}, {0x12F82E5F, 0},
+    {0x12F85C30, 1}, {0x12F877C2, 0}, {0x12F8A7CF, 1}, {0x12F8BF91, 0},
+    {0x12F8F18D, 1}, {0x12F93529, 0}, {0x12F96509, 1}, {0x12F9A78B, 0},
+    {0x12F9DBFE, 1}, {0x12F9F7A1, 0}, {0x12FA2909, 1}, {0x12FA3FF3, 0},
+    {0x12FA6D04, 1}, {0x12FA885B, 0}, {0x12FAB9E9, 1}, {0x12FAD5ED, 0},
+    {0x12FB02ED, 1}, {0x12FB1BAE, 0}, {0x12FB4D2F, 1}, {0x12FB65DB, 0},
+    {0x12FB963F, 1}, {0x12FBAF06, 0}, {0x12FBDF13, 1}, {0x12FBF66B, 0},
+    {0x12FC28F4, 1}, {0x12FC3F2F, 0}, {0x12FC6F04, 1}, {0x12FCB36C, 0},
+    {0x12FCE74A, 1}, {0x12FD02FE, 0}, {0x12FD340D, 1}, {0x12FD78E2, 0},
+    {0x12FDA93F, 1}, {0x12FDC173, 0}, {0x12FDF41F, 1}, {0x12FE3673, 0},
+    {0x12FE664F, 1}, {0x12FEAB6E, 0}, {0x12FEDD63, 1}, {0x12FF1DEE, 0},
+    {0x12FF4B41, 1}, {0x12FF8D9B, 0}, {0x12FFC1ED, 1}, {0x13000681, 0},
+    {0x130033D0, 1}, {0x1300781C, 0}, {0x1300A60B, 1}, {0x1300EAB4, 0},
+    {0x13011ECF, 1}, {0x13015F92, 0}, {0x13018D10, 1}, {0x1301A8B0, 0},
+    {0x1301D9EA, 1}, {0x13021FF4, 0}, {0x13024DDA, 1}, {0x13029196, 0},
+    {0x1302C08C, 1}, {0x130306C7, 0}, {0x13033885, 1}, {0x130353AD, 0},
+    {0x1303855D, 1},
+};
+
+/* DHT22, the rising edge of bit 20 was not captured */
+static const dht_edge_t capture_dht22_missing_edge[] = {
+    {0x5A0C68A0, 1}, {0x5A0C86D3, 0}, {0x5A0CD399, 1}, {0x5A0D1D29, 0},
+    {0x5A0D4AD8, 1}, {0x5A0D6611, 0}, {0x5A0D9924, 1}, {0x5A0DB386, 0},
+    {0x5A0DE5A3, 1}, {0x5A0DFDA1, 0}, {0x5A0E2F29, 1}, {0x5A0E452D, 0},
+    {0x5A0E7250, 1}, {0x5A0E8B8F, 0}, {0x5A0EBB7F, 1}, {0x5A0ED636, 0},
+    {0x5A0F064C, 1}, {0x5A0F4A23, 0}, {0x5A0F7D89, 1}, {0x5A0F97AE, 0},
+    {0x5A0FC907, 1}, {0x5A100F39, 0}, {0x5A104230, 1}, {0x5A1057EF, 0},
+    {0x5A1088A4, 1}, {0x5A10A1D4, 0}, {0x5A10D0D1, 1}, {0x5A10E716, 0},
+    {0x5A11181A, 1}, {0x5A115DE8, 0}, {0x5A118DCC, 1}, {0x5A11CDE1, 0},
+    {0x5A1201EB, 1}, {0x5A121B5F, 0}, {0x5A124E7A, 1}, {0x5A126509, 0},
+    {0x5A129662, 1}, {0x5A12B002, 0}, {0x5A12E14E, 1}, {0x5A12F6B4, 0},
+    {0x5A132882, 1}, {0x5A13407F, 0}, {0x5A136FA2, 1}, {0x5A1386AD, 0},
+    {0x5A13D30E, 0}, {0x5A140728, 1}, {0x5A142153, 0}, {0x5A1452D2, 1},
+    {0x5A146907, 0}, {0x5A14980D, 1}, {0x5A14D936, 0}, {0x5A150883, 1},
+    {0x5A1523E1, 0}, {0x5A155336, 1}, {0x5A159494, 0}, {0x5A15C711, 1},
+    {0x5A15E1CD, 0}, {0x5A16126F, 1}, {0x5A165825, 0}, {0x5A1685A4, 1},
+    {0x5A16C9CD, 0}, {0x5A16FA55, 1}, {0x5A173B80, 0}, {0x5A176C69, 1},
+    {0x5A17AEBE, 0}, {0x5A17DD6A, 1}, {0x5A182361, 0}, {0x5A185749, 1},
+    {0x5A1898C2, 0}, {0x5A18C772, 1}, {0x5A190AD2, 0}, {0x5A1939C2, 1},
+    {0x5A197986, 0}, {0x5A19A75F, 1}, {0x5A19C140, 0}, {0x5A19F05C, 1},
+    {0x5A1A307A, 0}, {0x5A1A6384, 1}, {0x5A1AA698, 0}, {0x5A1AD3E4, 1},
+    {0x5A1B1926, 0}, {0x5A1B4726, 1}, {0x5A1B5D1D, 0}, {0x5A1B8BFD, 1},
+};
+
+/* DHT11, 53 %RH and 24 C */
+static const dht_edge_t capture_dht11_valid[] = {
+    {0x00041462, 1}, {0x00042FBB, 0}, {0x00047ED7, 1}, {0x0004CE99, 0},
+    {0x0004FF6C, 1}, {0x000518E0, 0}, {0x00054AD9, 1}, {0x000565D4, 0},
+    {0x00059507, 1}, {0x0005D5F6, 0}, {0x00060B54, 1}, {0x00064F4C, 0},
+    {0x00068427, 1}, {0x00069DE0, 0}, {0x0006D047, 1}, {0x0007113A, 0},
+    {0x000744CD, 1}, {0x00075F9C, 0}, {0x00079058, 1}, {0x0007D199, 0},
+    {0x0008009F, 1}, {0x00081B8F, 0}, {0x00084ED5, 1}, {0x0008692F, 0},
+    {0x00089A97, 1}, {0x0008B194, 0}, {0x0008E1BC, 1}, {0x0008FA45, 0},
+    {0x00092B7C, 1}, {0x00094619, 0}, {0x00097630, 1}, {0x000990CB, 0},
+    {0x0009C49F, 1}, {0x0009DD56, 0}, {0x000A118B, 1}, {0x000A2A1E, 0},
+    {0x000A5C38, 1}, {0x000A7612, 0}, {0x000AA9AC, 1}, {0x000ABFB2, 0},
+    {0x000AF2A8, 1}, {0x000B0CC6, 0}, {0x000B403A, 1}, {0x000B8335, 0},
+    {0x000BB297, 1}, {0x000BF6CA, 0}, {0x000C2A18, 1}, {0x000C42F5, 0},
+    {0x000C761B, 1}, {0x000C8F72, 0}, {0x000CBE8F, 1}, {0x000CD88F, 0},
+    {0x000D07D3, 1}, {0x000D2003, 0}, {0x000D51FA, 1}, {0x000D67FD, 0},
+    {0x000D97F5, 1}, {0x000DB0EF, 0}, {0x000DE123, 1}, {0x000DF852, 0},
+    {0x000E2A3C, 1}, {0x000E4155, 0}, {0x000E75A2, 1}, {0x000E8F7B, 0},
+    {0x000EC092, 1}, {0x000ED664, 0}, {0x000F07D5, 1}, {0x000F22F1, 0},
+    {0x000F51D7, 1}, {0x000F6A9D, 0}, {0x000F99F4, 1}, {0x000FDD8C, 0},
+    {0x00100F59, 1}, {0x00102920, 0}, {0x00105D5D, 1}, {0x00107682, 0},
+    {0x0010A830, 1}, {0x0010E8F2, 0}, {0x00111A10, 1}, {0x00115B5B, 0},
+    {0x00118C7A, 1}, {0x0011A4CB, 0}, {0x0011D4B9, 1}, {0x001215A9, 0},
+    {0x00124849, 1},
+};
+
+/* line held low by a fault: one falling edge, never released */
+static const dht_edge_t capture_stuck_low[] = {
+    {0x3C0021F4, 0},
+};
+
+/* no sensor on the line: only the release by the host */
+static const dht_edge_t capture_no_sensor[] = {
+    {0x7D61A0E8, 1},
+};
+
+#endif /* _DHT_CAPTURES_H_ */
+
+// -----------------------------------------------------------------------------
+//                              EOF
+// -----------------------------------------------------------------------------
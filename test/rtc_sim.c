@@ -0,0 +1,108 @@
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <string.h>
+#include "rtc_sim.h"
+
+// -----------------------------------------------------------------------------
+//                               Local functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Read registers of the simulated chip.
+ ******************************************************************************/
+static esp_err_t rtc_sim_read(void *ctx, uint8_t addr, uint8_t reg,
+                              uint8_t *data, size_t len)
+{
+    rtc_sim_t *sim = ctx;
+
+    sim->transfers++;
+    if((addr != sim->address) || (reg + len > sim->reg_count)) {
+        return ESP_FAIL;
+    }
+    memcpy(data, sim->regs + reg, len);
+    return ESP_OK;
+}
+
+/***************************************************************************//**
+ *  Write registers of the simulated chip.
+ ******************************************************************************/
+static esp_err_t rtc_sim_write(void *ctx, uint8_t addr, uint8_t reg,
+                               const uint8_t *data, size_t len)
+{
+    rtc_sim_t *sim = ctx;
+
+    sim->transfers++;
+    if((addr != sim->address) || (reg + len > sim->reg_count)) {
+        return ESP_FAIL;
+    }
+    memcpy(sim->regs + reg, data, len);
+    return ESP_OK;
+}
+
+// -----------------------------------------------------------------------------
+//                               Public functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Start a simulated chip.
+ ******************************************************************************/
+void rtc_sim_init(rtc_sim_t *sim, const rtc_ops_t *ops, rtc_bus_t *bus)
+{
+    memset(sim, 0, sizeof(*sim));
+    sim->address = ops->address;
+    sim->reg_count = ops->reg_count;
+    bus->read = rtc_sim_read;
+    bus->write = rtc_sim_write;
+    bus->ctx = sim;
+}
+
+// -----------------------------------------------------------------------------
+//                               I2C
+// -----------------------------------------------------------------------------
+
+// rtc_bus_i2c() links against the I2C driver, never called on the host
+
+i2c_cmd_handle_t i2c_cmd_link_create(void)
+{
+    return NULL;
+}
+
+void i2c_cmd_link_delete(i2c_cmd_handle_t cmd)
+{
+}
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd)
+{
+    return ESP_FAIL;
+}
+
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd)
+{
+    return ESP_FAIL;
+}
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data,
+                                bool ack_en)
+{
+    return ESP_FAIL;
+}
+
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd, const uint8_t *data,
+                           size_t len, bool ack_en)
+{
+    return ESP_FAIL;
+}
+
+esp_err_t i2c_master_read(i2c_cmd_handle_t cmd, uint8_t *data, size_t len,
+                          i2c_ack_type_t ack)
+{
+    return ESP_FAIL;
+}
+
+esp_err_t i2c_master_cmd_begin(i2c_port_t i2c_num, i2c_cmd_handle_t cmd,
+                               TickType_t wait)
+{
+    return ESP_FAIL;
+}
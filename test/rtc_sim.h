@@ -0,0 +1,40 @@
+#ifndef _RTC_SIM_H_
+#define _RTC_SIM_H_
+
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include "rtc.h"
+
+// -----------------------------------------------------------------------------
+//                               Typedefs
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    uint8_t address;        /* 7-bit I2C address the chip answers */
+    uint8_t reg_count;      /* registers the chip has */
+    uint8_t regs[64];
+    uint32_t transfers;     /* reads and writes so far */
+} rtc_sim_t; /* register file of a simulated RTC chip */
+
+// -----------------------------------------------------------------------------
+//                               Public functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ * @brief
+ *  Start a simulated chip with all registers 0 and make its bus. Transfers
+ *  to another address or past the last register fail like a NACK would.
+ *
+ * @param[out] sim
+ *  The chip.
+ * @param[in] ops
+ *  The backend, for the address and the register count.
+ * @param[out] bus
+ *  The bus to give to rtc_init().
+ ******************************************************************************/
+void rtc_sim_init(rtc_sim_t *sim, const rtc_ops_t *ops, rtc_bus_t *bus);
+
+#endif /* _RTC_SIM_H_ */
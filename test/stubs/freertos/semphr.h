@@ -0,0 +1,15 @@
+#ifndef _SEMPHR_H_
+#define _SEMPHR_H_
+
+// Host stand-in for the ESP-IDF header, the test provides the functions
+
+#include "freertos/FreeRTOS.h"
+
+typedef void *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t wait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+void vSemaphoreDelete(SemaphoreHandle_t sem);
+
+#endif /* _SEMPHR_H_ */
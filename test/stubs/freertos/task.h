@@ -0,0 +1,18 @@
+#ifndef _TASK_H_
+#define _TASK_H_
+
+// Host stand-in for the ESP-IDF header, the test provides the functions
+
+#include "freertos/FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *arg);
+
+void vTaskDelay(TickType_t ticks);
+BaseType_t xTaskCreate(TaskFunction_t task, const char *name,
+                       uint32_t stack_size, void *arg,
+                       UBaseType_t priority, TaskHandle_t *handle);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+
+#endif /* _TASK_H_ */
@@ -0,0 +1,50 @@
+#ifndef _TEST_H_
+#define _TEST_H_
+
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// -----------------------------------------------------------------------------
+//                               Macros
+// -----------------------------------------------------------------------------
+
+// stop the test program at the first failed check
+#define TEST_ASSERT(cond)                                                   \
+    do {                                                                    \
+        if(!(cond)) {                                                       \
+            printf("%s:%d: FAIL: %s\n", __FILE__, __LINE__, #cond);         \
+            exit(1);                                                        \
+        }                                                                   \
+    } while(0)
+
+#define TEST_ASSERT_EQUAL(expected, actual)                                 \
+    do {                                                                    \
+        long long _e = (long long)(expected), _a = (long long)(actual);     \
+        if(_e != _a) {                                                      \
+            printf("%s:%d: FAIL: %s == %lld, expected %lld\n",              \
+                   __FILE__, __LINE__, #actual, _a, _e);                    \
+            exit(1);                                                        \
+        }                                                                   \
+    } while(0)
+
+// -----------------------------------------------------------------------------
+//                               Inline functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Monotonic time in nanoseconds, for the benchmarks.
+ ******************************************************************************/
+static inline long long test_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+#endif /* _TEST_H_ */
@@ -0,0 +1,226 @@
+// -----------------------------------------------------------------------------
+//                              Includes
+// -----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <string.h>
+#include "dht_decode.h"
+#include "test.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros
+// -----------------------------------------------------------------------------
+
+#define BENCH_COUNT             2000000
+#define ZERO_HIGH_US            26
+#define ONE_HIGH_US             70
+
+// -----------------------------------------------------------------------------
+//                              Typedefs
+// -----------------------------------------------------------------------------
+
+typedef struct
+{
+    uint8_t data[DHT_FRAME_BYTES];
+    dht_decode_status_t status;
+    int16_t temp11;
+    uint16_t humid11;
+    int16_t temp22;
+    uint16_t humid22;
+}frame_case_t; /**< one frame and what both sensor types read from it */
+
+// -----------------------------------------------------------------------------
+//                              Variables
+// -----------------------------------------------------------------------------
+
+static const frame_case_t frame_cases[] = {
+    /* DHT22 datasheet: 65.2 %RH, 35.1 C */
+    {{0x02, 0x8C, 0x01, 0x5F, 0xEE}, DHT_DECODE_OK,  105, 160, 351, 652},
+    /* DHT22 datasheet: -10.1 C */
+    {{0x02, 0x8C, 0x80, 0x65, 0x73}, DHT_DECODE_OK, 1381, 160, -101, 652},
+    /* DHT11 datasheet: 53 %RH, 24 C */
+    {{0x35, 0x00, 0x18, 0x00, 0x4D}, DHT_DECODE_OK,  240, 530, 6144, 13568},
+    /* DHT11 with decimals: 45.3 %RH, -2.7 C */
+    {{0x2D, 0x03, 0x02, 0x87, 0xB9}, DHT_DECODE_OK,  -27, 453, 647, 11523},
+    /* DHT22 negative zero */
+    {{0x00, 0x00, 0x80, 0x00, 0x80}, DHT_DECODE_OK,  1280, 0, 0, 0},
+    /* largest values */
+    {{0xFF, 0xFF, 0xFF, 0xFF, 0xFC}, DHT_DECODE_OK, -2677, 2805, -32767,
+     65535},
+    /* checksum off by one bit */
+    {{0x02, 0x8C, 0x01, 0x5F, 0xEF}, DHT_DECODE_CHECKSUM, 0, 0, 0, 0},
+    /* checksum carries out of the byte */
+    {{0x80, 0x80, 0x80, 0x80, 0x00}, DHT_DECODE_OK,  -1280, 1408, -128,
+     32896},
+};
+
+// -----------------------------------------------------------------------------
+//                       Local Function Definitions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Build the pulse train the sensor sends for a frame.
+ ******************************************************************************/
+static void frame_to_pulses(const uint8_t data[DHT_FRAME_BYTES],
+                            dht_pulse_t pulse[DHT_FRAME_PULSES])
+{
+    pulse[0].low_us = 80;
+    pulse[0].high_us = 80;
+    for(uint8_t i = 0; i < DHT_FRAME_BITS; i++)
+    {
+        pulse[i + 1].low_us = 50;
+        pulse[i + 1].high_us = (data[i / 8] & (0x80 >> (i % 8)))
+                               ? ONE_HIGH_US : ZERO_HIGH_US;
+    }
+}
+
+/***************************************************************************//**
+ *  Decode a frame through its pulses and check it comes back unchanged.
+ ******************************************************************************/
+static dht_decode_status_t decode_frame(const uint8_t data[DHT_FRAME_BYTES])
+{
+    dht_pulse_t pulse[DHT_FRAME_PULSES];
+    uint8_t out[DHT_FRAME_BYTES];
+    dht_decode_status_t status;
+
+    frame_to_pulses(data, pulse);
+    status = dht_decode_pulses(pulse, DHT_FRAME_PULSES, out, NULL);
+    TEST_ASSERT(memcmp(data, out, DHT_FRAME_BYTES) == 0);
+    return status;
+}
+
+// -----------------------------------------------------------------------------
+//                              Tests
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Known frames.
+ ******************************************************************************/
+static void test_table(void)
+{
+    for(size_t i = 0; i < sizeof(frame_cases) / sizeof(frame_cases[0]); i++)
+    {
+        const frame_case_t *c = &frame_cases[i];
+        dht_reading_t reading;
+
+        TEST_ASSERT_EQUAL(c->status, decode_frame(c->data));
+        if(c->status != DHT_DECODE_OK)
+            continue;
+        dht_decode_dht11(c->data, &reading);
+        TEST_ASSERT_EQUAL(c->temp11, reading.temp);
+        TEST_ASSERT_EQUAL(c->humid11, reading.humid);
+        dht_decode_dht22(c->data, &reading);
+        TEST_ASSERT_EQUAL(c->temp22, reading.temp);
+        TEST_ASSERT_EQUAL(c->humid22, reading.humid);
+    }
+}
+
+/***************************************************************************//**
+ *  All 40-bit frames, in parts that decode independently: every value of
+ *  the humidity and of the temperature word through both conversions, and
+ *  every checksum byte through the pulse decoder.
+ ******************************************************************************/
+static void test_exhaustive(void)
+{
+    long checked = 0;
+
+    for(uint32_t word = 0; word <= 0xFFFF; word++)
+    {
+        uint8_t hi = word >> 8, lo = word & 0xFF;
+        /* the other word runs through its own values at a different pace */
+        uint16_t other = word * 40503u;
+        uint8_t humid_data[DHT_FRAME_BYTES] = {hi, lo, other >> 8, other};
+        uint8_t temp_data[DHT_FRAME_BYTES] = {other >> 8, other, hi, lo};
+        int16_t magnitude = word & 0x7FFF;
+        int16_t temp11 = hi * 10 + (lo & 0x7F);
+        dht_reading_t reading;
+
+        dht_decode_dht22(humid_data, &reading);
+        TEST_ASSERT_EQUAL(word, reading.humid);
+        dht_decode_dht22(temp_data, &reading);
+        TEST_ASSERT_EQUAL((word & 0x8000) ? -magnitude : magnitude,
+                          reading.temp);
+
+        dht_decode_dht11(humid_data, &reading);
+        TEST_ASSERT_EQUAL(hi * 10 + lo, reading.humid);
+        dht_decode_dht11(temp_data, &reading);
+        TEST_ASSERT_EQUAL((lo & 0x80) ? -temp11 : temp11, reading.temp);
+        checked += 4;
+    }
+
+    /* every checksum byte against data that walks all four bytes */
+    for(uint32_t n = 0; n < 0x10000; n++)
+    {
+        uint32_t value = n * 2654435761u;
+        uint8_t data[DHT_FRAME_BYTES] = {
+            value >> 24, value >> 16, value >> 8, value
+        };
+        uint8_t sum = data[0] + data[1] + data[2] + data[3];
+
+        for(uint32_t check = 0; check < 256; check++)
+        {
+            data[4] = check;
+            TEST_ASSERT_EQUAL((check == sum) ? DHT_DECODE_OK
+                                             : DHT_DECODE_CHECKSUM,
+                              decode_frame(data));
+            checked++;
+        }
+    }
+    printf("test_dht_decode: %ld frames checked\n", checked);
+}
+
+/***************************************************************************//**
+ *  Time the decoders.
+ ******************************************************************************/
+static void bench(void)
+{
+    dht_pulse_t pulse[DHT_FRAME_PULSES];
+    uint8_t data[DHT_FRAME_BYTES] = {0x02, 0x8C, 0x01, 0x5F, 0xEE};
+    volatile int32_t sink = 0;
+    dht_reading_t reading;
+    long long start, pulses_ns, dht11_ns, dht22_ns;
+
+    frame_to_pulses(data, pulse);
+    start = test_now_ns();
+    for(long n = 0; n < BENCH_COUNT; n++)
+    {
+        pulse[1 + n % DHT_FRAME_BITS].high_us ^= (ONE_HIGH_US ^ ZERO_HIGH_US);
+        sink += dht_decode_pulses(pulse, DHT_FRAME_PULSES, data, NULL);
+    }
+    pulses_ns = test_now_ns() - start;
+
+    start = test_now_ns();
+    for(long n = 0; n < BENCH_COUNT; n++)
+    {
+        data[1] = n;
+        data[3] = n >> 3;
+        dht_decode_dht11(data, &reading);
+        sink += reading.temp + reading.humid;
+    }
+    dht11_ns = test_now_ns() - start;
+
+    start = test_now_ns();
+    for(long n = 0; n < BENCH_COUNT; n++)
+    {
+        data[1] = n;
+        data[3] = n >> 3;
+        dht_decode_dht22(data, &reading);
+        sink += reading.temp + reading.humid;
+    }
+    dht22_ns = test_now_ns() - start;
+
+    printf("test_dht_decode: dht_decode_pulses %.1f ns, "
+           "dht_decode_dht11 %.1f ns, dht_decode_dht22 %.1f ns\n",
+           (double)pulses_ns / BENCH_COUNT, (double)dht11_ns / BENCH_COUNT,
+           (double)dht22_ns / BENCH_COUNT);
+    (void)sink;
+}
+
+int main(void)
+{
+    test_table();
+    test_exhaustive();
+    bench();
+    printf("test_dht_decode: OK\n");
+    return 0;
+}
@@ -0,0 +1,91 @@
+// -----------------------------------------------------------------------------
+//                              Includes
+// -----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include "dht_filter.h"
+#include "test.h"
+
+// -----------------------------------------------------------------------------
+//                              Tests
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Full-scale steps through the moving average, where the weighted
+ *  difference no longer fits 32 bits.
+ ******************************************************************************/
+static void test_ema_full_scale(void)
+{
+    const dht_filter_config_t config = {.ema_alpha_q8 = 255};
+    dht_reading_t in = {.temp = -32767, .humid = 0};
+    dht_reading_t out;
+    dht_filter_t filter;
+
+    dht_filter_init(&filter, &config);
+    TEST_ASSERT(dht_filter_update(&filter, &in, &out));
+    TEST_ASSERT_EQUAL(-32767, out.temp);
+
+    in.temp = 32767;
+    TEST_ASSERT(dht_filter_update(&filter, &in, &out));
+    /* 255/256 of the way up, exactly: -32767 + 65534 * 255 / 256 */
+    TEST_ASSERT_EQUAL(32511, out.temp);
+
+    in.temp = -32767;
+    TEST_ASSERT(dht_filter_update(&filter, &in, &out));
+    TEST_ASSERT_EQUAL(-32512, out.temp);
+}
+
+/***************************************************************************//**
+ *  The average moves toward a new level and settles on it.
+ ******************************************************************************/
+static void test_ema_settles(void)
+{
+    const dht_filter_config_t config = {.ema_alpha_q8 = 64};
+    dht_reading_t in = {.temp = 200, .humid = 500};
+    dht_reading_t out;
+    dht_filter_t filter;
+
+    dht_filter_init(&filter, &config);
+    dht_filter_update(&filter, &in, &out);
+    in.temp = 300;
+    in.humid = 400;
+    dht_filter_update(&filter, &in, &out);
+    TEST_ASSERT_EQUAL(225, out.temp);
+    TEST_ASSERT_EQUAL(475, out.humid);
+    for(int i = 0; i < 100; i++)
+        dht_filter_update(&filter, &in, &out);
+    TEST_ASSERT_EQUAL(300, out.temp);
+    TEST_ASSERT_EQUAL(400, out.humid);
+}
+
+/***************************************************************************//**
+ *  A glitch is rejected and the output keeps its value.
+ ******************************************************************************/
+static void test_reject(void)
+{
+    const dht_filter_config_t config = {
+        .temp_max_step = 50, .humid_max_step = 100, .max_rejects = 3
+    };
+    dht_reading_t in = {.temp = 200, .humid = 500};
+    dht_reading_t out;
+    dht_filter_t filter;
+
+    dht_filter_init(&filter, &config);
+    TEST_ASSERT(dht_filter_update(&filter, &in, &out));
+    in.temp = 900;
+    TEST_ASSERT(!dht_filter_update(&filter, &in, &out));
+    TEST_ASSERT_EQUAL(200, out.temp);
+    TEST_ASSERT(!dht_filter_update(&filter, &in, &out));
+    /* the third reading at the new level is taken as real */
+    TEST_ASSERT(dht_filter_update(&filter, &in, &out));
+    TEST_ASSERT_EQUAL(900, out.temp);
+}
+
+int main(void)
+{
+    test_ema_full_scale();
+    test_ema_settles();
+    test_reject();
+    printf("test_dht_filter: OK\n");
+    return 0;
+}
@@ -0,0 +1,154 @@
+// -----------------------------------------------------------------------------
+//                              Includes
+// -----------------------------------------------------------------------------
+
+#include <math.h>
+#include <stdint.h>
+#include "dht_metrics.h"
+#include "test.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros
+// -----------------------------------------------------------------------------
+
+/* bounds documented in dht_metrics.h */
+#define DEW_POINT_MAX_ERROR     0.07    /**< C */
+#define HEAT_INDEX_MAX_ERROR    0.06    /**< C */
+#define ABS_HUMID_MAX_ERROR     0.05    /**< g/m3 */
+
+// -----------------------------------------------------------------------------
+//                       Local Function Definitions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Saturation vapor pressure in Pa, Magnus formula with Sonntag constants.
+ ******************************************************************************/
+static double ref_sat_pressure(double temp)
+{
+    return 611.2 * exp(17.62 * temp / (243.12 + temp));
+}
+
+/***************************************************************************//**
+ *  Dew point in C, the Magnus formula solved for the temperature.
+ ******************************************************************************/
+static double ref_dew_point(double temp, double humid)
+{
+    double g = log(humid / 100.0) + 17.62 * temp / (243.12 + temp);
+
+    return 243.12 * g / (17.62 - g);
+}
+
+/***************************************************************************//**
+ *  Heat index in C, the NWS algorithm in Fahrenheit.
+ ******************************************************************************/
+static double ref_heat_index(double temp, double humid)
+{
+    double f = temp * 1.8 + 32.0;
+    double hi = 0.5 * (f + 61.0 + (f - 68.0) * 1.2 + humid * 0.094);
+
+    if((hi + f) / 2.0 >= 80.0)
+    {
+        hi = -42.379 + 2.04901523 * f + 10.14333127 * humid
+             - 0.22475541 * f * humid - 0.00683783 * f * f
+             - 0.05481717 * humid * humid + 0.00122874 * f * f * humid
+             + 0.00085282 * f * humid * humid
+             - 0.00000199 * f * f * humid * humid;
+        if((humid < 13.0) && (f >= 80.0) && (f <= 112.0))
+            hi -= ((13.0 - humid) / 4.0) * sqrt((17.0 - fabs(f - 95.0)) / 17.0);
+        else if((humid > 85.0) && (f >= 80.0) && (f <= 87.0))
+            hi += ((humid - 85.0) / 10.0) * ((87.0 - f) / 5.0);
+    }
+    return (hi - 32.0) / 1.8;
+}
+
+/***************************************************************************//**
+ *  Absolute humidity in g/m3, ideal gas with the Magnus vapor pressure.
+ ******************************************************************************/
+static double ref_abs_humidity(double temp, double humid)
+{
+    return 2.16679 * ref_sat_pressure(temp) * humid / 100.0
+           / (temp + 273.15);
+}
+
+// -----------------------------------------------------------------------------
+//                              Tests
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Every reading of the table range, -40..80 C and 0..100 % in tenths,
+ *  against the formulas in double.
+ ******************************************************************************/
+static void test_sweep(void)
+{
+    double dew_max = 0.0, heat_max = 0.0, abs_max = 0.0;
+
+    for(int16_t t = DHT_METRICS_TEMP_MIN; t <= DHT_METRICS_TEMP_MAX; t++)
+    {
+        for(uint16_t h = 0; h <= 1000; h++)
+        {
+            dht_reading_t reading = {.temp = t, .humid = h};
+            double temp = t / 10.0, humid = h / 10.0;
+            dht_metrics_t metrics;
+            double error;
+
+            dht_metrics_init(&metrics, &reading);
+            if(h > 0)
+            {
+                double dew = ref_dew_point(temp, humid);
+                int16_t got = dht_metrics_dew_point(&metrics);
+
+                if(dew >= -40.0)
+                    error = fabs(got / 10.0 - dew);
+                else
+                    error = fabs(got / 10.0 + 40.0);
+                if(error > dew_max)
+                    dew_max = error;
+            }
+            error = fabs(dht_metrics_heat_index(&metrics) / 10.0
+                         - ref_heat_index(temp, humid));
+            if(error > heat_max)
+                heat_max = error;
+            error = fabs(dht_metrics_abs_humidity(&metrics) / 100.0
+                         - ref_abs_humidity(temp, humid));
+            if(error > abs_max)
+                abs_max = error;
+        }
+    }
+    printf("test_dht_metrics: max error dew point %.4f C, heat index %.4f C, "
+           "absolute humidity %.4f g/m3\n", dew_max, heat_max, abs_max);
+    TEST_ASSERT(dew_max <= DEW_POINT_MAX_ERROR);
+    TEST_ASSERT(heat_max <= HEAT_INDEX_MAX_ERROR);
+    TEST_ASSERT(abs_max <= ABS_HUMID_MAX_ERROR);
+}
+
+/***************************************************************************//**
+ *  Readings outside the table are clamped.
+ ******************************************************************************/
+static void test_clamp(void)
+{
+    dht_reading_t reading = {.temp = 1250, .humid = 1500};
+    dht_reading_t edge = {.temp = DHT_METRICS_TEMP_MAX, .humid = 1000};
+    dht_metrics_t metrics, expected;
+
+    dht_metrics_init(&metrics, &reading);
+    dht_metrics_init(&expected, &edge);
+    TEST_ASSERT_EQUAL(dht_metrics_dew_point(&expected),
+                      dht_metrics_dew_point(&metrics));
+    TEST_ASSERT_EQUAL(dht_metrics_abs_humidity(&expected),
+                      dht_metrics_abs_humidity(&metrics));
+
+    reading.temp = -600;
+    edge.temp = DHT_METRICS_TEMP_MIN;
+    dht_metrics_init(&metrics, &reading);
+    dht_metrics_init(&expected, &edge);
+    TEST_ASSERT_EQUAL(dht_metrics_abs_humidity(&expected),
+                      dht_metrics_abs_humidity(&metrics));
+}
+
+int main(void)
+{
+    test_sweep();
+    test_clamp();
+    printf("test_dht_metrics: OK\n");
+    return 0;
+}
@@ -0,0 +1,190 @@
+// -----------------------------------------------------------------------------
+//                              Includes
+// -----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <string.h>
+#include "dht_decode.h"
+#include "fixtures/dht_captures.h"
+#include "test.h"
+
+// -----------------------------------------------------------------------------
+//                              Macros
+// -----------------------------------------------------------------------------
+
+#define EDGE_COUNT(capture)     (sizeof(capture) / sizeof((capture)[0]))
+
+// -----------------------------------------------------------------------------
+//                       Local Function Definitions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Convert and decode a capture the way dht_finish() does.
+ ******************************************************************************/
+static dht_decode_status_t decode_capture(const dht_edge_t *edge,
+                                          size_t edge_count,
+                                          size_t *pulse_count,
+                                          uint8_t data[DHT_FRAME_BYTES],
+                                          dht_pulse_stats_t *stats)
+{
+    dht_pulse_t pulse[DHT_FRAME_PULSES];
+
+    *pulse_count = dht_edges_to_pulses(edge, edge_count,
+                                       CAPTURE_TICKS_PER_US,
+                                       pulse, DHT_FRAME_PULSES);
+    return dht_decode_pulses(pulse, *pulse_count, data, stats);
+}
+
+/***************************************************************************//**
+ *  Check the pulse widths of a frame fall where the sensor puts them.
+ ******************************************************************************/
+static void check_stats(const dht_pulse_stats_t *stats)
+{
+    TEST_ASSERT(stats->response_low_us >= 75 && stats->response_low_us <= 90);
+    TEST_ASSERT(stats->response_high_us >= 75
+                && stats->response_high_us <= 90);
+    TEST_ASSERT_EQUAL(stats->response_high_us * 6 / 10, stats->threshold_us);
+    TEST_ASSERT(stats->zero_min_us >= 20);
+    TEST_ASSERT(stats->zero_max_us <= stats->threshold_us);
+    TEST_ASSERT(stats->one_min_us > stats->threshold_us);
+    TEST_ASSERT(stats->one_max_us <= 75);
+    TEST_ASSERT(stats->low_max_us <= 57);
+}
+
+// -----------------------------------------------------------------------------
+//                              Tests
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Good frames, one across the wrap of the cycle counter.
+ ******************************************************************************/
+static void test_valid(void)
+{
+    static const uint8_t frame22[DHT_FRAME_BYTES] = {
+        0x02, 0x8C, 0x01, 0x5F, 0xEE
+    };
+    static const uint8_t frame11[DHT_FRAME_BYTES] = {
+        0x35, 0x00, 0x18, 0x00, 0x4D
+    };
+    uint8_t data[DHT_FRAME_BYTES];
+    dht_pulse_stats_t stats;
+    dht_reading_t reading;
+    size_t last = EDGE_COUNT(capture_dht22_valid) - 1;
+    size_t count;
+
+    TEST_ASSERT(capture_dht22_valid[0].time > capture_dht22_valid[last].time);
+    TEST_ASSERT_EQUAL(DHT_DECODE_OK,
+                      decode_capture(capture_dht22_valid,
+                                     EDGE_COUNT(capture_dht22_valid),
+                                     &count, data, &stats));
+    TEST_ASSERT_EQUAL(DHT_FRAME_PULSES, count);
+    TEST_ASSERT(memcmp(frame22, data, DHT_FRAME_BYTES) == 0);
+    check_stats(&stats);
+    dht_decode_dht22(data, &reading);
+    TEST_ASSERT_EQUAL(351, reading.temp);
+    TEST_ASSERT_EQUAL(652, reading.humid);
+
+    TEST_ASSERT_EQUAL(DHT_DECODE_OK,
+                      decode_capture(capture_dht11_valid,
+                                     EDGE_COUNT(capture_dht11_valid),
+                                     &count, data, &stats));
+    TEST_ASSERT(memcmp(frame11, data, DHT_FRAME_BYTES) == 0);
+    check_stats(&stats);
+    dht_decode_dht11(data, &reading);
+    TEST_ASSERT_EQUAL(240, reading.temp);
+    TEST_ASSERT_EQUAL(530, reading.humid);
+}
+
+/***************************************************************************//**
+ *  A complete frame with a bad bit: the checksum catches it and the stats
+ *  still describe the frame.
+ ******************************************************************************/
+static void test_checksum(void)
+{
+    uint8_t data[DHT_FRAME_BYTES];
+    dht_pulse_stats_t stats;
+    size_t count;
+
+    TEST_ASSERT_EQUAL(DHT_DECODE_CHECKSUM,
+                      decode_capture(capture_dht22_checksum,
+                                     EDGE_COUNT(capture_dht22_checksum),
+                                     &count, data, &stats));
+    TEST_ASSERT_EQUAL(DHT_FRAME_PULSES, count);
+    TEST_ASSERT_EQUAL(0x8C | 0x40, data[1]);
+    TEST_ASSERT_EQUAL(51, stats.one_min_us);
+}
+
+/***************************************************************************//**
+ *  A missed edge ends the conversion, the bits before it are kept.
+ ******************************************************************************/
+static void test_missing_edge(void)
+{
+    uint8_t data[DHT_FRAME_BYTES];
+    dht_pulse_stats_t stats = {0};
+    size_t count;
+
+    TEST_ASSERT_EQUAL(DHT_DECODE_SHORT_FRAME,
+                      decode_capture(capture_dht22_missing_edge,
+                                     EDGE_COUNT(capture_dht22_missing_edge),
+                                     &count, data, &stats));
+    TEST_ASSERT_EQUAL(1 + 20, count);
+    TEST_ASSERT_EQUAL(0, stats.threshold_us);
+}
+
+/***************************************************************************//**
+ *  No pulse at all, whether the line is held low or nothing answers.
+ ******************************************************************************/
+static void test_no_response(void)
+{
+    uint8_t data[DHT_FRAME_BYTES];
+    size_t count;
+
+    TEST_ASSERT_EQUAL(DHT_DECODE_NO_RESPONSE,
+                      decode_capture(capture_stuck_low,
+                                     EDGE_COUNT(capture_stuck_low),
+                                     &count, data, NULL));
+    TEST_ASSERT_EQUAL(0, count);
+    TEST_ASSERT_EQUAL(DHT_DECODE_NO_RESPONSE,
+                      decode_capture(capture_no_sensor,
+                                     EDGE_COUNT(capture_no_sensor),
+                                     &count, data, NULL));
+    TEST_ASSERT_EQUAL(0, count);
+    TEST_ASSERT_EQUAL(DHT_DECODE_NO_RESPONSE,
+                      decode_capture(capture_no_sensor, 0, &count, data,
+                                     NULL));
+}
+
+/***************************************************************************//**
+ *  Truncated captures and a small output, as when the ISR runs out of
+ *  room: the conversion never reads or writes past either end.
+ ******************************************************************************/
+static void test_bounds(void)
+{
+    dht_pulse_t pulse[DHT_FRAME_PULSES + 1];
+    size_t edge_count = EDGE_COUNT(capture_dht22_valid);
+
+    for(size_t n = 0; n <= edge_count; n++)
+    {
+        size_t count = dht_edges_to_pulses(capture_dht22_valid, n,
+                                           CAPTURE_TICKS_PER_US,
+                                           pulse, DHT_FRAME_PULSES);
+        /* edge 0 is the release, a pulse ends on the edge the next starts */
+        TEST_ASSERT_EQUAL((n < 4) ? 0 : (n - 2) / 2, count);
+    }
+
+    memset(pulse, 0xA5, sizeof(pulse));
+    TEST_ASSERT_EQUAL(5, dht_edges_to_pulses(capture_dht22_valid, edge_count,
+                                             CAPTURE_TICKS_PER_US, pulse, 5));
+    TEST_ASSERT_EQUAL(0xA5A5, pulse[5].low_us);
+}
+
+int main(void)
+{
+    test_valid();
+    test_checksum();
+    test_missing_edge();
+    test_no_response();
+    test_bounds();
+    printf("test_dht_pulses: OK\n");
+    return 0;
+}
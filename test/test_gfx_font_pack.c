@@ -0,0 +1,281 @@
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include "test.h"
+#include "gfx_font_pack.c"
+
+// -----------------------------------------------------------------------------
+//                               Macros
+// -----------------------------------------------------------------------------
+
+// one font "digits" with '0' and '1', 3x5 glyphs of 2 bitmap bytes each
+#define ENTRY_OFFSET        24
+#define GLYPH_OFFSET        60
+#define BITMAP_OFFSET       76
+#define BITMAP_SIZE         4
+#define PACK_SIZE           80
+
+// -----------------------------------------------------------------------------
+//                               Local variables
+// -----------------------------------------------------------------------------
+
+static uint32_t image_words[PACK_SIZE / 4 + 1];
+static uint8_t *const image = (uint8_t *)image_words;
+static gfx_font_pack_header_t *const header =
+    (gfx_font_pack_header_t *)image_words;
+static gfx_font_pack_entry_t *const entry =
+    (gfx_font_pack_entry_t *)((uint8_t *)image_words + ENTRY_OFFSET);
+static gfx_glyph_t *const glyph =
+    (gfx_glyph_t *)((uint8_t *)image_words + GLYPH_OFFSET);
+
+// -----------------------------------------------------------------------------
+//                               Local functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Recompute the CRC after a field was changed.
+ ******************************************************************************/
+static void seal(void)
+{
+    header->crc32 = gfx_font_pack_crc32(image + header->header_size,
+                                        header->total_size
+                                        - header->header_size);
+}
+
+/***************************************************************************//**
+ *  Build the valid pack.
+ ******************************************************************************/
+static void build(void)
+{
+    static const gfx_glyph_t glyphs[2] = {
+        {0, 3, 5, 4, 0, -5},
+        {2, 3, 5, 4, 0, -5},
+    };
+    static const uint8_t bitmaps[BITMAP_SIZE] = {0xF6, 0xDE, 0x59, 0x2E};
+
+    memset(image_words, 0, sizeof(image_words));
+    memcpy(header->magic, GFX_FONT_PACK_MAGIC, 4);
+    header->version = GFX_FONT_PACK_VERSION;
+    header->header_size = sizeof(gfx_font_pack_header_t);
+    header->total_size = PACK_SIZE;
+    header->font_count = 1;
+    strcpy(entry->name, "digits");
+    entry->glyph_offset = GLYPH_OFFSET;
+    entry->bitmap_offset = BITMAP_OFFSET;
+    entry->bitmap_size = BITMAP_SIZE;
+    entry->first = '0';
+    entry->last = '1';
+    entry->y_advance = 6;
+    memcpy(glyph, glyphs, sizeof(glyphs));
+    memcpy(image + BITMAP_OFFSET, bitmaps, BITMAP_SIZE);
+    seal();
+}
+
+/***************************************************************************//**
+ *  Write the first len bytes of the image to a temporary file.
+ ******************************************************************************/
+static void write_file(char *path, size_t len)
+{
+    int fd;
+
+    strcpy(path, "/tmp/test_gfx_font_pack_XXXXXX");
+    fd = mkstemp(path);
+    TEST_ASSERT(fd >= 0);
+    TEST_ASSERT(write(fd, image, len) == (ssize_t)len);
+    close(fd);
+}
+
+// -----------------------------------------------------------------------------
+//                               Tests
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  A valid pack mapped from a file, its font used in place.
+ ******************************************************************************/
+static void test_valid_file(void)
+{
+    gfx_font_pack_t pack;
+    const gfx_font_t *font;
+    char path[64];
+
+    build();
+    write_file(path, PACK_SIZE);
+    TEST_ASSERT_EQUAL(ESP_OK, gfx_font_pack_open_file(&pack, path));
+    unlink(path);
+    TEST_ASSERT_EQUAL(1, pack.font_count);
+    TEST_ASSERT_EQUAL(PACK_SIZE, pack.size);
+    TEST_ASSERT(gfx_font_pack_find(&pack, "other") == NULL);
+    font = gfx_font_pack_find(&pack, "digits");
+    TEST_ASSERT(font != NULL);
+    TEST_ASSERT_EQUAL('0', font->first);
+    TEST_ASSERT_EQUAL('1', font->last);
+    TEST_ASSERT_EQUAL(6, font->y_advance);
+    TEST_ASSERT_EQUAL(2, font->glyph[1].bitmap_offset);
+    TEST_ASSERT_EQUAL(-5, font->glyph[1].y_offset);
+    TEST_ASSERT_EQUAL(0x59, font->bitmap[font->glyph[1].bitmap_offset]);
+    TEST_ASSERT((const uint8_t *)font->bitmap == pack.base + BITMAP_OFFSET);
+    gfx_font_pack_close(&pack);
+    TEST_ASSERT_EQUAL(0, pack.font_count);
+
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND,
+                      gfx_font_pack_open_file(&pack, "/nonexistent/pack"));
+}
+
+/***************************************************************************//**
+ *  Truncated files, cut inside the payload and inside the header.
+ ******************************************************************************/
+static void test_truncated(void)
+{
+    gfx_font_pack_t pack;
+    char path[64];
+
+    build();
+    write_file(path, PACK_SIZE - 1);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+                      gfx_font_pack_open_file(&pack, path));
+    unlink(path);
+    write_file(path, sizeof(gfx_font_pack_header_t) - 1);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+                      gfx_font_pack_open_file(&pack, path));
+    unlink(path);
+    write_file(path, 0);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+                      gfx_font_pack_open_file(&pack, path));
+    unlink(path);
+}
+
+/***************************************************************************//**
+ *  Bad headers: magic, version, arguments and table sizes.
+ ******************************************************************************/
+static void test_header(void)
+{
+    gfx_font_pack_t pack;
+
+    build();
+    TEST_ASSERT_EQUAL(ESP_OK, gfx_font_pack_load(&pack, image, PACK_SIZE));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG,
+                      gfx_font_pack_load(&pack, image + 1, PACK_SIZE - 1));
+
+    header->magic[3] = 'Q';
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_VERSION,
+                      gfx_font_pack_load(&pack, image, PACK_SIZE));
+    build();
+    header->version = GFX_FONT_PACK_VERSION + 1;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_VERSION,
+                      gfx_font_pack_load(&pack, image, PACK_SIZE));
+
+    build();
+    header->header_size = 28;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+                      gfx_font_pack_load(&pack, image, PACK_SIZE));
+    build();
+    header->font_count = GFX_FONT_PACK_MAX_FONTS + 1;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+                      gfx_font_pack_load(&pack, image, PACK_SIZE));
+    // The entry table runs past the end of the pack
+    build();
+    header->font_count = 2;
+    header->total_size = GLYPH_OFFSET + 8;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+                      gfx_font_pack_load(&pack, image, PACK_SIZE));
+    // total_size is checked before the CRC is read past the image
+    build();
+    header->total_size = 0xFFFFFFF0;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+                      gfx_font_pack_load(&pack, image, PACK_SIZE));
+}
+
+/***************************************************************************//**
+ *  Any changed payload byte fails the CRC.
+ ******************************************************************************/
+static void test_crc(void)
+{
+    gfx_font_pack_t pack;
+
+    for(uint32_t i = sizeof(gfx_font_pack_header_t); i < PACK_SIZE; i++) {
+        build();
+        image[i] ^= 0x01;
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_CRC,
+                          gfx_font_pack_load(&pack, image, PACK_SIZE));
+    }
+    build();
+    header->crc32 ^= 0x80000000;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_CRC,
+                      gfx_font_pack_load(&pack, image, PACK_SIZE));
+}
+
+/***************************************************************************//**
+ *  Entries and glyphs pointing outside the pack, with a valid CRC.
+ ******************************************************************************/
+static void test_offsets(void)
+{
+    gfx_font_pack_t pack;
+
+    // Glyph table past the end, and wrapping around 32 bits
+    build();
+    entry->glyph_offset = PACK_SIZE - 8;
+    seal();
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+                      gfx_font_pack_load(&pack, image, PACK_SIZE));
+    build();
+    entry->glyph_offset = 0xFFFFFFF8;
+    seal();
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+                      gfx_font_pack_load(&pack, image, PACK_SIZE));
+    // Glyph table not aligned for gfx_glyph_t
+    build();
+    entry->glyph_offset = GLYPH_OFFSET + 2;
+    seal();
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+                      gfx_font_pack_load(&pack, image, PACK_SIZE));
+    // More glyphs than the table holds
+    build();
+    entry->last = 0xFFFF;
+    seal();
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+                      gfx_font_pack_load(&pack, image, PACK_SIZE));
+    build();
+    entry->first = '2';
+    seal();
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+                      gfx_font_pack_load(&pack, image, PACK_SIZE));
+
+    // Bitmap area past the end
+    build();
+    entry->bitmap_offset = PACK_SIZE - 2;
+    seal();
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+                      gfx_font_pack_load(&pack, image, PACK_SIZE));
+    build();
+    entry->bitmap_size = 0xFFFFFFFF;
+    seal();
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+                      gfx_font_pack_load(&pack, image, PACK_SIZE));
+    // A glyph bitmap past the font bitmap area, by offset and by size
+    build();
+    glyph[1].bitmap_offset = BITMAP_SIZE - 1;
+    seal();
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+                      gfx_font_pack_load(&pack, image, PACK_SIZE));
+    build();
+    glyph[0].width = 255;
+    glyph[0].height = 255;
+    seal();
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+                      gfx_font_pack_load(&pack, image, PACK_SIZE));
+}
+
+int main(void)
+{
+    test_valid_file();
+    test_truncated();
+    test_header();
+    test_crc();
+    test_offsets();
+    printf("test_gfx_font_pack: OK\n");
+    return 0;
+}
@@ -0,0 +1,431 @@
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <string.h>
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include "rtc.h"
+#include "rtc_ds1307_clock.h"
+#include "rtc_sim.h"
+#include "test.h"
+
+// -----------------------------------------------------------------------------
+//                               Macros
+// -----------------------------------------------------------------------------
+
+#define EPOCH_2000          946684800LL
+#define EPOCH_2100          4102444800LL
+
+// -----------------------------------------------------------------------------
+//                               Local variables
+// -----------------------------------------------------------------------------
+
+static const rtc_ops_t *const backends[] = {
+    &rtc_backend_ds1307,
+    &rtc_backend_ds3231,
+    &rtc_backend_pcf8563,
+};
+
+static rtc_sim_t sim;
+static rtc_dev_t dev;
+
+// -----------------------------------------------------------------------------
+//                               Fakes
+// -----------------------------------------------------------------------------
+
+static int64_t fake_us;
+static TaskFunction_t fake_task;        // created, never run
+
+int64_t esp_timer_get_time(void)
+{
+    return fake_us;
+}
+
+// Time passes while the clock service sleeps, the simulated DS1307 ticks on
+// every whole second unless its clock is halted
+void vTaskDelay(TickType_t ticks)
+{
+    int64_t next_us = fake_us + (int64_t)ticks * 1000000 / configTICK_RATE_HZ;
+
+    if((next_us / 1000000 != fake_us / 1000000) && !(sim.regs[0] & 0x80)) {
+        sim.regs[0] = RTC_BIN_2_BCD((RTC_BCD_2_BIN(sim.regs[0]) + 1) % 60);
+    }
+    fake_us = next_us;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t task, const char *name,
+                       uint32_t stack_size, void *arg,
+                       UBaseType_t priority, TaskHandle_t *handle)
+{
+    fake_task = task;
+    *handle = (TaskHandle_t)1;
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait)
+{
+    return 0;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    return pdPASS;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t pin, gpio_mode_t mode)
+{
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_pull_mode(gpio_num_t pin, gpio_pull_mode_t pull)
+{
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t pin, gpio_int_type_t type)
+{
+    return ESP_OK;
+}
+
+esp_err_t gpio_install_isr_service(int flags)
+{
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t pin, gpio_isr_t isr, void *arg)
+{
+    return ESP_OK;
+}
+
+// The DS1307 driver keeps its device private, the test puts it on the sim
+#include "rtc_ds1307.c"
+
+// -----------------------------------------------------------------------------
+//                               Local functions
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Put the device on a fresh simulated chip.
+ ******************************************************************************/
+static void start(const rtc_ops_t *ops)
+{
+    rtc_bus_t bus;
+
+    rtc_sim_init(&sim, ops, &bus);
+    rtc_init(&dev, ops, &bus);
+}
+
+// -----------------------------------------------------------------------------
+//                               Tests
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Set and get back every week of 2000 to 2099, the time of day moving on
+ *  by 1:01:01 each step. The chips store the weekday as they count it.
+ ******************************************************************************/
+static void test_round_trip(const rtc_ops_t *ops)
+{
+    start(ops);
+    TEST_ASSERT_EQUAL(2099, ops->year_max);
+    for(long long epoch = EPOCH_2000; epoch < EPOCH_2100;
+        epoch += 7 * 86400 + 3661) {
+        date_time_t dt, read;
+        uint8_t weekday_reg = (ops == &rtc_backend_pcf8563) ? 6 : 3;
+        uint8_t weekday_first = (ops == &rtc_backend_pcf8563) ? 0 : 1;
+
+        rtc_epoch_to_date_time(epoch, &dt);
+        TEST_ASSERT_EQUAL(ESP_OK, rtc_set_time(&dev, &dt));
+        TEST_ASSERT_EQUAL(dt.day_of_week + weekday_first,
+                          sim.regs[weekday_reg]);
+        memset(&read, 0xAA, sizeof(read));
+        TEST_ASSERT_EQUAL(ESP_OK, rtc_get_time(&dev, &read));
+        TEST_ASSERT(memcmp(&dt, &read, sizeof(dt)) == 0);
+    }
+}
+
+/***************************************************************************//**
+ *  Out-of-range dates and register ranges.
+ ******************************************************************************/
+static void test_range(const rtc_ops_t *ops)
+{
+    date_time_t dt = {.year = 2023, .month = 2, .date = 29};
+    uint8_t regs[2];
+
+    start(ops);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, rtc_set_time(&dev, &dt));
+    dt = (date_time_t) {.year = 2024, .month = 2, .date = 29};
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_set_time(&dev, &dt));
+    dt = (date_time_t) {.year = 2100, .month = 1, .date = 1};
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, rtc_set_time(&dev, &dt));
+    dt = (date_time_t) {.year = 1999, .month = 12, .date = 31};
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, rtc_set_time(&dev, &dt));
+    dt = (date_time_t) {.year = 2024, .month = 1, .date = 1, .hour = 24};
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, rtc_set_time(&dev, &dt));
+
+    sim.transfers = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG,
+                      rtc_read_registers(&dev, ops->reg_count - 1, regs, 2));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG,
+                      rtc_write_registers(&dev, ops->reg_count, regs, 1));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, rtc_read_registers(&dev, 0, regs, 0));
+    TEST_ASSERT_EQUAL(0, sim.transfers);
+    TEST_ASSERT_EQUAL(ESP_OK,
+                      rtc_read_registers(&dev, ops->reg_count - 2, regs, 2));
+}
+
+/***************************************************************************//**
+ *  12-hour mode written by another driver reads back as 24-hour.
+ ******************************************************************************/
+static void test_12_hour(const rtc_ops_t *ops)
+{
+    static const struct {
+        uint8_t reg;
+        uint8_t hour;
+    } cases[] = {
+        {0x40 | 0x12, 0},           // 12 AM
+        {0x40 | 0x01, 1},           // 1 AM
+        {0x40 | 0x11, 11},          // 11 AM
+        {0x40 | 0x20 | 0x12, 12},   // 12 PM
+        {0x40 | 0x20 | 0x01, 13},   // 1 PM
+        {0x40 | 0x20 | 0x11, 23},   // 11 PM
+        {0x23, 23},                 // 24-hour mode
+    };
+    date_time_t dt;
+
+    start(ops);
+    sim.regs[4] = 0x15;     // 2024-03-15
+    sim.regs[5] = 0x03;
+    sim.regs[6] = 0x24;
+    for(size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        sim.regs[2] = cases[i].reg;
+        TEST_ASSERT_EQUAL(ESP_OK, rtc_get_time(&dev, &dt));
+        TEST_ASSERT_EQUAL(cases[i].hour, dt.hour);
+        TEST_ASSERT_EQUAL(15, dt.date);
+        TEST_ASSERT_EQUAL(5, dt.day_of_week);   // Friday
+    }
+}
+
+/***************************************************************************//**
+ *  Oscillator flags: the time still comes back, with ESP_ERR_INVALID_STATE,
+ *  and setting the time clears the flag.
+ ******************************************************************************/
+static void test_flags(void)
+{
+    date_time_t dt = {.year = 2024, .month = 6, .date = 1, .hour = 12};
+    date_time_t read;
+
+    // DS1307 clock halt, bit 7 of seconds
+    start(&rtc_backend_ds1307);
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_set_time(&dev, &dt));
+    sim.regs[0] |= 0x80;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, rtc_get_time(&dev, &read));
+    TEST_ASSERT_EQUAL(12, read.hour);
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_set_time(&dev, &dt));
+    TEST_ASSERT_EQUAL(0, sim.regs[0] & 0x80);
+
+    // DS3231 oscillator stop flag, in the status register
+    start(&rtc_backend_ds3231);
+    sim.regs[0x0F] = 0x80 | 0x08;
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_set_time(&dev, &dt));
+    TEST_ASSERT_EQUAL(0x08, sim.regs[0x0F]);
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_get_time(&dev, &read));
+    sim.regs[0x0F] |= 0x80;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, rtc_get_time(&dev, &read));
+    // Century bit set by a roll over from 2099
+    sim.regs[0x05] |= 0x80;
+    sim.regs[0x0F] = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_get_time(&dev, &read));
+    TEST_ASSERT_EQUAL(2124, read.year);
+
+    // PCF8563 voltage low, bit 7 of seconds
+    start(&rtc_backend_pcf8563);
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_set_time(&dev, &dt));
+    sim.regs[0x02] |= 0x80;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, rtc_get_time(&dev, &read));
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_set_time(&dev, &dt));
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_get_time(&dev, &read));
+}
+
+/***************************************************************************//**
+ *  DS3231 alarm 1 and control registers.
+ ******************************************************************************/
+static void test_alarm_ds3231(void)
+{
+    rtc_alarm_t alarm = {0, 30, 6, RTC_ALARM_ANY};
+    bool fired;
+
+    start(&rtc_backend_ds3231);
+    sim.regs[0x0E] = 0x18;      // RS bits, kept
+    sim.regs[0x0F] = 0x01;      // stale A1F
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_set_alarm(&dev, &alarm));
+    TEST_ASSERT_EQUAL(0x00, sim.regs[0x07]);
+    TEST_ASSERT_EQUAL(0x30, sim.regs[0x08]);
+    TEST_ASSERT_EQUAL(0x06, sim.regs[0x09]);
+    TEST_ASSERT_EQUAL(0x80, sim.regs[0x0A]);
+    TEST_ASSERT_EQUAL(0x18 | 0x04 | 0x01, sim.regs[0x0E]);
+    TEST_ASSERT_EQUAL(0x00, sim.regs[0x0F]);
+
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_check_alarm(&dev, &fired));
+    TEST_ASSERT(!fired);
+    sim.regs[0x0F] = 0x80 | 0x01;
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_check_alarm(&dev, &fired));
+    TEST_ASSERT(fired);
+    TEST_ASSERT_EQUAL(0x80, sim.regs[0x0F]);
+
+    // Every second, then a field after an ignored one
+    alarm = (rtc_alarm_t) {RTC_ALARM_ANY, RTC_ALARM_ANY, RTC_ALARM_ANY,
+                           RTC_ALARM_ANY};
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_set_alarm(&dev, &alarm));
+    TEST_ASSERT_EQUAL(0x80, sim.regs[0x07]);
+    alarm.minute = 5;
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, rtc_set_alarm(&dev, &alarm));
+    alarm = (rtc_alarm_t) {60, 0, 0, 1};
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, rtc_set_alarm(&dev, &alarm));
+
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_disable_alarm(&dev));
+    TEST_ASSERT_EQUAL(0x18 | 0x04, sim.regs[0x0E]);
+}
+
+/***************************************************************************//**
+ *  PCF8563 alarm and control register 2.
+ ******************************************************************************/
+static void test_alarm_pcf8563(void)
+{
+    rtc_alarm_t alarm = {0, 30, 6, RTC_ALARM_ANY};
+    bool fired;
+
+    start(&rtc_backend_pcf8563);
+    sim.regs[0x01] = 0x08 | 0x10;   // stale AF, TI_TP kept
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_set_alarm(&dev, &alarm));
+    TEST_ASSERT_EQUAL(0x30, sim.regs[0x09]);
+    TEST_ASSERT_EQUAL(0x06, sim.regs[0x0A]);
+    TEST_ASSERT_EQUAL(0x80, sim.regs[0x0B]);
+    TEST_ASSERT_EQUAL(0x80, sim.regs[0x0C]);
+    TEST_ASSERT_EQUAL(0x10 | 0x02, sim.regs[0x01]);
+
+    sim.regs[0x01] |= 0x08 | 0xE0;  // AF, and bits the chip reads as junk
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_check_alarm(&dev, &fired));
+    TEST_ASSERT(fired);
+    TEST_ASSERT_EQUAL(0x10 | 0x02, sim.regs[0x01]);
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_check_alarm(&dev, &fired));
+    TEST_ASSERT(!fired);
+
+    alarm.second = 30;
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, rtc_set_alarm(&dev, &alarm));
+    alarm = (rtc_alarm_t) {0, RTC_ALARM_ANY, RTC_ALARM_ANY, RTC_ALARM_ANY};
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, rtc_set_alarm(&dev, &alarm));
+
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_disable_alarm(&dev));
+    TEST_ASSERT_EQUAL(0x10, sim.regs[0x01]);
+}
+
+/***************************************************************************//**
+ *  Operations the chip does not have, and the DS3231 temperature.
+ ******************************************************************************/
+static void test_optional(void)
+{
+    static const struct {
+        uint8_t msb;
+        uint8_t lsb;
+        int16_t temp;
+    } cases[] = {
+        {0x19, 0x00, 2500},
+        {0x19, 0xC0, 2575},
+        {0x00, 0x40, 25},
+        {0xFF, 0xC0, -25},      // -1 + 0.75
+        {0xE7, 0x40, -2475},    // -25 + 0.25
+        {0x7F, 0xC0, 12775},
+        {0x80, 0x00, -12800},
+    };
+    rtc_alarm_t alarm = {0, 0, 0, RTC_ALARM_ANY};
+    int16_t temp;
+    bool fired;
+
+    start(&rtc_backend_ds1307);
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, rtc_set_alarm(&dev, &alarm));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, rtc_disable_alarm(&dev));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, rtc_check_alarm(&dev, &fired));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, rtc_get_temperature(&dev, &temp));
+    start(&rtc_backend_pcf8563);
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, rtc_get_temperature(&dev, &temp));
+
+    start(&rtc_backend_ds3231);
+    for(size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        sim.regs[0x11] = cases[i].msb;
+        sim.regs[0x12] = cases[i].lsb;
+        TEST_ASSERT_EQUAL(ESP_OK, rtc_get_temperature(&dev, &temp));
+        TEST_ASSERT_EQUAL(cases[i].temp, temp);
+    }
+}
+
+/***************************************************************************//**
+ *  Clock service on DS1307: an aligned read lands on the tick, and on a
+ *  halted chip it times out while init and sync keep the frozen time. Get
+ *  only extrapolates, the resync task does the reads.
+ ******************************************************************************/
+static void test_clock_ds1307(void)
+{
+    date_time_t dt = {.year = 2024, .month = 6, .date = 1, .hour = 12,
+                      .minute = 30, .second = 10};
+    date_time_t read;
+    uint32_t transfers;
+    int64_t start_us;
+    rtc_bus_t bus;
+
+    rtc_sim_init(&sim, &rtc_backend_ds1307, &bus);
+    rtc_init(&rtc_ds1307_dev, &rtc_backend_ds1307, &bus);
+    fake_us = 100000000 + 250000;
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_set_time(&rtc_ds1307_dev, &dt));
+
+    // Running, the seconds register ticks at the next whole fake second
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_ds1307_clock_read_aligned(&read, &start_us));
+    TEST_ASSERT_EQUAL(11, read.second);
+    TEST_ASSERT(start_us > 101000000 - RTC_DS1307_CLOCK_ALIGN_POLL_MS * 1000);
+    TEST_ASSERT(start_us <= 101000000 + RTC_DS1307_CLOCK_ALIGN_POLL_MS * 1000);
+
+    // Halted, the register never ticks
+    sim.regs[0] |= 0x80;
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT,
+                      rtc_ds1307_clock_read_aligned(&read, &start_us));
+    TEST_ASSERT_EQUAL(11, read.second);
+    TEST_ASSERT_EQUAL(fake_us, start_us);
+
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_ds1307_clock_init(0, true));
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_ds1307_clock_get(&read));
+    TEST_ASSERT_EQUAL(30, read.minute);
+    TEST_ASSERT_EQUAL(11, read.second);
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_ds1307_clock_init(0, false));
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_ds1307_clock_sync());
+    TEST_ASSERT(fake_task == NULL);
+
+    // With an interval the resync is left to the task, get stays off I2C
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_ds1307_clock_init(1, true));
+    TEST_ASSERT(fake_task != NULL);
+    transfers = sim.transfers;
+    fake_us += 10000000;
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_ds1307_clock_get(&read));
+    TEST_ASSERT_EQUAL(21, read.second);
+    TEST_ASSERT_EQUAL(transfers, sim.transfers);
+
+    // A failing bus is still an error
+    sim.address = 0;
+    TEST_ASSERT_EQUAL(ESP_FAIL, rtc_ds1307_clock_sync());
+}
+
+int main(void)
+{
+    for(size_t i = 0; i < sizeof(backends) / sizeof(backends[0]); i++) {
+        test_round_trip(backends[i]);
+        test_range(backends[i]);
+    }
+    test_12_hour(&rtc_backend_ds1307);
+    test_12_hour(&rtc_backend_ds3231);
+    test_flags();
+    test_alarm_ds3231();
+    test_alarm_pcf8563();
+    test_optional();
+    test_clock_ds1307();
+    printf("test_rtc: OK\n");
+    return 0;
+}
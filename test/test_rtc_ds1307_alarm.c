@@ -0,0 +1,244 @@
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include <time.h>
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include "test.h"
+
+// -----------------------------------------------------------------------------
+//                               Fakes
+// -----------------------------------------------------------------------------
+
+static time_t fake_now;
+static int64_t fake_armed_us = -1;      // -1 when the timer is stopped
+
+static time_t fake_time(time_t *t)
+{
+    return fake_now;
+}
+
+static int fake_gettimeofday(struct timeval *tv, void *tz)
+{
+    tv->tv_sec = fake_now;
+    tv->tv_usec = 0;
+    return 0;
+}
+
+// The service reads the system time through these
+#define time                fake_time
+#define gettimeofday        fake_gettimeofday
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args,
+                           esp_timer_handle_t *handle)
+{
+    *handle = (esp_timer_handle_t)1;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    fake_armed_us = timeout_us;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    fake_armed_us = -1;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    return ESP_OK;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return (SemaphoreHandle_t)1;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t wait)
+{
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    return pdTRUE;
+}
+
+#include "rtc_ds1307_alarm.c"
+
+// -----------------------------------------------------------------------------
+//                               Reference model
+// -----------------------------------------------------------------------------
+
+#define ITERATIONS          500000
+
+typedef struct {
+    int id;
+    time_t when;
+    uint32_t period_s;
+    bool used;
+} model_alarm_t;
+
+static model_alarm_t model[RTC_DS1307_ALARM_MAX];
+static int model_fired;
+
+/***************************************************************************//**
+ *  Alarm callback, checks the alarm is due and moves the model on.
+ ******************************************************************************/
+static void model_cb(int id, void *arg)
+{
+    model_alarm_t *alarm = &model[id % RTC_DS1307_ALARM_MAX];
+
+    TEST_ASSERT(alarm->used);
+    TEST_ASSERT_EQUAL(alarm->id, id);
+    TEST_ASSERT(alarm->when <= fake_now);
+    model_fired++;
+    if(alarm->period_s > 0) {
+        alarm->when += ((fake_now - alarm->when) / alarm->period_s + 1)
+                       * alarm->period_s;
+    } else {
+        alarm->used = false;
+    }
+}
+
+/***************************************************************************//**
+ *  Earliest pending deadline of the model.
+ ******************************************************************************/
+static bool model_earliest(time_t *when)
+{
+    bool any = false;
+
+    for(int i = 0; i < RTC_DS1307_ALARM_MAX; i++) {
+        if(model[i].used && (!any || (model[i].when < *when))) {
+            *when = model[i].when;
+            any = true;
+        }
+    }
+    return any;
+}
+
+// -----------------------------------------------------------------------------
+//                               Tests
+// -----------------------------------------------------------------------------
+
+static int reuse_stale_id;
+static int reuse_new_id;
+
+/***************************************************************************//**
+ *  Callback that adds an alarm, which takes the slot just freed.
+ ******************************************************************************/
+static void reuse_cb(int id, void *arg)
+{
+    reuse_stale_id = id;
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_ds1307_alarm_add(fake_now + 100, 0, reuse_cb,
+                                                   NULL, &reuse_new_id));
+}
+
+/***************************************************************************//**
+ *  The id of a one-shot alarm that fired does not cancel the alarm that
+ *  reuses its slot.
+ ******************************************************************************/
+static void test_stale_id(void)
+{
+    int id;
+
+    fake_now = 1000;
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_ds1307_alarm_add(fake_now, 0, reuse_cb,
+                                                   NULL, &id));
+    rtc_ds1307_alarm_timer_cb(NULL);
+    TEST_ASSERT_EQUAL(id, reuse_stale_id);
+    TEST_ASSERT(reuse_new_id != id);
+    TEST_ASSERT_EQUAL(id % RTC_DS1307_ALARM_MAX,
+                      reuse_new_id % RTC_DS1307_ALARM_MAX);
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, rtc_ds1307_alarm_cancel(id));
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_ds1307_alarm_cancel(reuse_new_id));
+    TEST_ASSERT_EQUAL(0, alarm_count);
+}
+
+/***************************************************************************//**
+ *  Random adds, cancels with live and stale ids, and timer expiries against
+ *  the model: every alarm fires once per due deadline and never early, and
+ *  the timer is always armed for the earliest one.
+ ******************************************************************************/
+static void test_model(void)
+{
+    int stale[64] = {0};
+    size_t stale_count = 0;
+
+    srand(3);
+    fake_now = 1000000;
+    for(long it = 0; it < ITERATIONS; it++) {
+        int action = rand() % 10;
+
+        if(action < 4) {
+            time_t when = fake_now + rand() % 500 - 50;
+            uint32_t period_s = (rand() % 3) ? 0 : 1 + rand() % 100;
+            int id;
+
+            if(rtc_ds1307_alarm_add(when, period_s, model_cb, NULL,
+                                    &id) == ESP_OK) {
+                model_alarm_t *alarm = &model[id % RTC_DS1307_ALARM_MAX];
+                TEST_ASSERT(!alarm->used);
+                *alarm = (model_alarm_t) {id, when, period_s, true};
+            } else {
+                TEST_ASSERT_EQUAL(RTC_DS1307_ALARM_MAX, alarm_count);
+            }
+        } else if(action < 6) {
+            model_alarm_t *alarm = &model[rand() % RTC_DS1307_ALARM_MAX];
+            bool use_stale = (stale_count > 0) && (rand() % 2);
+            int id = use_stale ? stale[rand() % stale_count] : alarm->id;
+            bool live = false;
+
+            for(int i = 0; i < RTC_DS1307_ALARM_MAX; i++) {
+                if(model[i].used && (model[i].id == id)) {
+                    alarm = &model[i];
+                    live = true;
+                }
+            }
+            TEST_ASSERT_EQUAL(live ? ESP_OK : ESP_ERR_NOT_FOUND,
+                              rtc_ds1307_alarm_cancel(id));
+            if(live) {
+                alarm->used = false;
+                stale[stale_count++ % 64] = id;
+                if(stale_count > 64) {
+                    stale_count = 64;
+                }
+            }
+        } else {
+            time_t when = 0;
+            bool any = model_earliest(&when);
+
+            TEST_ASSERT_EQUAL(any, fake_armed_us >= 0);
+            if(any) {
+                TEST_ASSERT_EQUAL((when > fake_now)
+                                  ? (int64_t)(when - fake_now) * 1000000 : 1,
+                                  fake_armed_us);
+                if(when > fake_now) {
+                    fake_now = when;
+                }
+                rtc_ds1307_alarm_timer_cb(NULL);
+                for(int i = 0; i < RTC_DS1307_ALARM_MAX; i++) {
+                    TEST_ASSERT(!model[i].used || (model[i].when > fake_now));
+                }
+            }
+        }
+    }
+    TEST_ASSERT(model_fired > ITERATIONS / 10);
+}
+
+int main(void)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_ds1307_alarm_init());
+    test_stale_id();
+    test_model();
+    printf("test_rtc_ds1307_alarm: OK\n");
+    return 0;
+}
@@ -0,0 +1,136 @@
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "test.h"
+#include "rtc_ds1307_kv.c"
+
+// -----------------------------------------------------------------------------
+//                               Fakes
+// -----------------------------------------------------------------------------
+
+#define ITERATIONS          200000
+
+static uint8_t fake_nvram[RTC_DS1307_NVRAM_SIZE];
+static int fake_tear = -1;          // bytes that land before the power loss
+static long fake_written;
+
+esp_err_t rtc_ds1307_nvram_read(uint8_t offset, void *data, size_t len)
+{
+    TEST_ASSERT(offset + len <= RTC_DS1307_NVRAM_SIZE);
+    memcpy(data, fake_nvram + offset, len);
+    return ESP_OK;
+}
+
+esp_err_t rtc_ds1307_nvram_write(uint8_t offset, const void *data, size_t len)
+{
+    TEST_ASSERT(offset + len <= RTC_DS1307_NVRAM_SIZE);
+    fake_written += len;
+    if(fake_tear >= 0) {
+        // The bytes are sent in order, the power loss cuts the transfer
+        memcpy(fake_nvram + offset, data, fake_tear % len);
+        fake_tear = -1;
+        return ESP_FAIL;
+    }
+    memcpy(fake_nvram + offset, data, len);
+    return ESP_OK;
+}
+
+// -----------------------------------------------------------------------------
+//                               Tests
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Random sets, some torn by a power loss, and reboots: after every reboot
+ *  each key reads back the last value whose set succeeded. Torn copies
+ *  whose CRC still matches must happen in the run, they are what the
+ *  sequence number being sent last protects against.
+ ******************************************************************************/
+static void test_torn_writes(void)
+{
+    uint32_t good[RTC_DS1307_KV_SLOTS] = {0};
+    bool has[RTC_DS1307_KV_SLOTS] = {false};
+    long crc_collisions = 0;
+
+    srand(1);
+    for(size_t i = 0; i < sizeof(fake_nvram); i++) {
+        fake_nvram[i] = rand();
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_ds1307_kv_init());
+
+    for(long it = 0; it < ITERATIONS; it++) {
+        uint8_t key = rand() % RTC_DS1307_KV_SLOTS;
+        uint32_t value = (rand() % 7 == 0) ? good[key] : (uint32_t)rand();
+        bool torn = (rand() % 10 == 0);
+        uint8_t before[RTC_DS1307_NVRAM_SIZE];
+        esp_err_t status;
+
+        if(torn) {
+            fake_tear = rand() % RTC_DS1307_KV_COPY_SIZE;
+        }
+        memcpy(before, fake_nvram, sizeof(before));
+        status = rtc_ds1307_kv_set(key, &value);
+        if(status == ESP_OK) {
+            good[key] = value;
+            has[key] = true;
+        } else {
+            // A copy changed by the torn write that still looks valid
+            TEST_ASSERT(torn);
+            for(uint8_t c = 0; c < 2; c++) {
+                size_t offset = rtc_ds1307_kv_copy(key, c) - kv_mirror;
+                const uint8_t *copy = fake_nvram + offset;
+                if((memcmp(copy, before + offset,
+                           RTC_DS1307_KV_COPY_SIZE) != 0)
+                   && (copy[COPY_CRC] == rtc_ds1307_kv_crc(key, copy))) {
+                    crc_collisions++;
+                }
+            }
+        }
+        fake_tear = -1;
+
+        if(rand() % 5 == 0) {
+            TEST_ASSERT_EQUAL(ESP_OK, rtc_ds1307_kv_init());
+            for(uint8_t k = 0; k < RTC_DS1307_KV_SLOTS; k++) {
+                uint32_t read;
+                if(has[k]) {
+                    TEST_ASSERT_EQUAL(ESP_OK, rtc_ds1307_kv_get(k, &read));
+                    TEST_ASSERT_EQUAL(good[k], read);
+                }
+            }
+        }
+    }
+    TEST_ASSERT(crc_collisions > 0);
+    printf("test_rtc_ds1307_kv: %ld torn copies passed the CRC, "
+           "%.2f bytes per set\n", crc_collisions,
+           (double)fake_written / ITERATIONS);
+}
+
+/***************************************************************************//**
+ *  Argument and state checks.
+ ******************************************************************************/
+static void test_args(void)
+{
+    uint32_t value = 0;
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG,
+                      rtc_ds1307_kv_get(RTC_DS1307_KV_SLOTS, &value));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG,
+                      rtc_ds1307_kv_set(RTC_DS1307_KV_SLOTS, &value));
+
+    // Blank NVRAM holds no valid copy
+    memset(fake_nvram, 0, sizeof(fake_nvram));
+    TEST_ASSERT_EQUAL(ESP_OK, rtc_ds1307_kv_init());
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, rtc_ds1307_kv_get(0, &value));
+}
+
+int main(void)
+{
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, rtc_ds1307_kv_get(0, NULL));
+    test_args();
+    test_torn_writes();
+    printf("test_rtc_ds1307_kv: OK\n");
+    return 0;
+}
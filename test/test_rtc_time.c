@@ -0,0 +1,128 @@
+// -----------------------------------------------------------------------------
+//                               Includes
+// -----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include "rtc_time.h"
+#include "test.h"
+
+// -----------------------------------------------------------------------------
+//                               Macros
+// -----------------------------------------------------------------------------
+
+#define EPOCH_2000          946684800LL
+#define EPOCH_2100          4102444800LL
+#define SECOND_STEP         97          // prime, walks every second of day
+#define BENCH_COUNT         2000000
+
+// -----------------------------------------------------------------------------
+//                               Tests
+// -----------------------------------------------------------------------------
+
+/***************************************************************************//**
+ *  Every day of 2000 to 2099, at seconds spread over the day: the date and
+ *  time match gmtime_r() and convert back to the same epoch.
+ ******************************************************************************/
+static void test_round_trip(void)
+{
+    long checked = 0;
+
+    for(long long day = EPOCH_2000; day < EPOCH_2100; day += 86400) {
+        // The offset moves each day so all seconds of the day get covered
+        for(long s = day / 86400 % SECOND_STEP; s < 86400; s += SECOND_STEP) {
+            time_t epoch = day + s;
+            struct tm tm;
+            date_time_t dt;
+
+            gmtime_r(&epoch, &tm);
+            rtc_epoch_to_date_time(epoch, &dt);
+            TEST_ASSERT_EQUAL(tm.tm_year + 1900, dt.year);
+            TEST_ASSERT_EQUAL(tm.tm_mon + 1, dt.month);
+            TEST_ASSERT_EQUAL(tm.tm_mday, dt.date);
+            TEST_ASSERT_EQUAL(tm.tm_hour, dt.hour);
+            TEST_ASSERT_EQUAL(tm.tm_min, dt.minute);
+            TEST_ASSERT_EQUAL(tm.tm_sec, dt.second);
+            TEST_ASSERT_EQUAL(tm.tm_wday, dt.day_of_week);
+            TEST_ASSERT_EQUAL(epoch, rtc_date_time_to_epoch(&dt));
+            checked++;
+        }
+        {
+            time_t epoch = day;
+            struct tm tm;
+
+            gmtime_r(&epoch, &tm);
+            TEST_ASSERT_EQUAL(tm.tm_wday,
+                              rtc_day_of_week(tm.tm_year + 1900,
+                                              tm.tm_mon + 1, tm.tm_mday));
+        }
+    }
+    printf("test_rtc_time: %ld times checked\n", checked);
+}
+
+/***************************************************************************//**
+ *  Outside the RTC range, before 1970 and after 2100.
+ ******************************************************************************/
+static void test_wide_range(void)
+{
+    for(long long epoch = -80LL * 365 * 86400; epoch < EPOCH_2100 + 400 * 86400;
+        epoch += 3599) {
+        time_t t = epoch;
+        struct tm tm;
+        date_time_t dt;
+
+        gmtime_r(&t, &tm);
+        rtc_epoch_to_date_time(t, &dt);
+        TEST_ASSERT_EQUAL(tm.tm_year + 1900, dt.year);
+        TEST_ASSERT_EQUAL(tm.tm_mon + 1, dt.month);
+        TEST_ASSERT_EQUAL(tm.tm_mday, dt.date);
+        TEST_ASSERT_EQUAL(tm.tm_wday, dt.day_of_week);
+        TEST_ASSERT_EQUAL(t, rtc_date_time_to_epoch(&dt));
+    }
+}
+
+/***************************************************************************//**
+ *  Against the C library, which goes through the time zone rules.
+ ******************************************************************************/
+static void bench(void)
+{
+    volatile time_t sink = 0;
+    long long start, lib_ns, own_ns;
+
+    setenv("TZ", "UTC0", 1);
+    tzset();
+
+    start = test_now_ns();
+    for(int i = 0; i < BENCH_COUNT; i++) {
+        struct tm tm = {
+            .tm_year = 100 + i % 100, .tm_mon = i % 12, .tm_mday = 1 + i % 28,
+            .tm_hour = i % 24,
+        };
+        sink += mktime(&tm);
+    }
+    lib_ns = test_now_ns() - start;
+
+    start = test_now_ns();
+    for(int i = 0; i < BENCH_COUNT; i++) {
+        date_time_t dt = {
+            .year = 2000 + i % 100, .month = 1 + i % 12, .date = 1 + i % 28,
+            .hour = i % 24,
+        };
+        sink += rtc_date_time_to_epoch(&dt);
+    }
+    own_ns = test_now_ns() - start;
+
+    printf("test_rtc_time: mktime %.1f ns, rtc_date_time_to_epoch %.1f ns\n",
+           (double)lib_ns / BENCH_COUNT, (double)own_ns / BENCH_COUNT);
+    (void)sink;
+}
+
+int main(void)
+{
+    test_round_trip();
+    test_wide_range();
+    bench();
+    printf("test_rtc_time: OK\n");
+    return 0;
+}